@@ -0,0 +1,59 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace secretsynth::dsp
+{
+// Hands immutable snapshots of T from the message thread to the audio thread. acquire() is
+// wait-free: it publishes the snapshot it is reading, and publish() frees only retired snapshots
+// that are not in use. Starts with a default-constructed T.
+template <typename T>
+class SharedSnapshot
+{
+public:
+    SharedSnapshot() { publish (T {}); }
+
+    SharedSnapshot (const SharedSnapshot&) = delete;
+    SharedSnapshot& operator= (const SharedSnapshot&) = delete;
+
+    // Message thread. Stores a copy of value and makes it current.
+    void publish (const T& value)
+    {
+        const std::lock_guard lock { publishLock };
+        snapshots.push_back (std::make_unique<T> (value));
+
+        const auto* latest = snapshots.back().get();
+        current.store (latest);
+
+        // The audio thread re-checks current after announcing inUse, so a snapshot it could still
+        // be reading is either latest or the one inUse names here.
+        const auto* reading = inUse.load();
+        std::erase_if (snapshots, [latest, reading] (const auto& candidate) { return candidate.get() != latest && candidate.get() != reading; });
+    }
+
+    // Audio thread, once per block. The snapshot stays valid until the next acquire().
+    [[nodiscard]] const T& acquire() noexcept
+    {
+        auto* snapshot = current.load();
+        for (;;)
+        {
+            inUse.store (snapshot);
+            auto* latest = current.load();
+            if (latest == snapshot)
+                return *snapshot;
+
+            snapshot = latest;
+        }
+    }
+
+private:
+    std::atomic<const T*> current { nullptr };
+    std::atomic<const T*> inUse { nullptr };
+    std::mutex publishLock;
+    std::vector<std::unique_ptr<T>> snapshots;
+};
+} // namespace secretsynth::dsp
@@ -1,5 +1,7 @@
 #include "MultiModeFilter.h"
 
+#include "../trace/Trace.h"
+
 #include <algorithm>
 #include <limits>
 
@@ -42,7 +44,7 @@ void MultiModeFilter::setKeyTrackingReferenceHz (float newReferenceHz) noexcept
     keyTrackingReferenceHz = std::max (newReferenceHz, 1.0f);
 }
 
-float MultiModeFilter::processSample (float input, float keyFrequencyHz) noexcept
+MultiModeFilter::Coefficients MultiModeFilter::computeCoefficients (float keyFrequencyHz) const noexcept
 {
     constexpr float pi = 3.14159265358979323846f;
 
@@ -57,9 +59,19 @@ float MultiModeFilter::processSample (float input, float keyFrequencyHz) noexcep
     const auto a2 = g * a1;
     const auto a3 = g * a2;
 
+    return { a1, a2, a3, k };
+}
+
+float MultiModeFilter::processSample (float input, float keyFrequencyHz) noexcept
+{
+    return processSample (input, computeCoefficients (keyFrequencyHz));
+}
+
+float MultiModeFilter::processSample (float input, const Coefficients& coefficients) noexcept
+{
     const auto v3 = input - ic2eq;
-    const auto v1 = a1 * ic1eq + a2 * v3;
-    const auto v2 = ic2eq + a2 * ic1eq + a3 * v3;
+    const auto v1 = coefficients.a1 * ic1eq + coefficients.a2 * v3;
+    const auto v2 = ic2eq + coefficients.a2 * ic1eq + coefficients.a3 * v3;
 
     ic1eq = flushDenormal (2.0f * v1 - ic1eq);
     ic2eq = flushDenormal (2.0f * v2 - ic2eq);
@@ -71,12 +83,20 @@ float MultiModeFilter::processSample (float input, float keyFrequencyHz) noexcep
         case Mode::bandPass:
             return flushDenormal (v1);
         case Mode::highPass:
-            return flushDenormal (input - k * v1 - v2);
+            return flushDenormal (input - coefficients.k * v1 - v2);
     }
 
     return 0.0f;
 }
 
+void MultiModeFilter::processBlock (float* samples, int numSamples, const Coefficients& coefficients) noexcept
+{
+    SECRETSYNTH_TRACE_SCOPE ("filter.processBlock");
+
+    for (int sample = 0; sample < numSamples; ++sample)
+        samples[sample] = processSample (samples[sample], coefficients);
+}
+
 float MultiModeFilter::flushDenormal (float value) noexcept
 {
     if (! std::isfinite (value) || std::abs (value) < std::numeric_limits<float>::min())
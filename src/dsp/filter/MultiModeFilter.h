@@ -14,6 +14,16 @@ public:
         highPass
     };
 
+    // Per-sample coefficients. Filters that share cutoff, resonance and key can compute these once
+    // and run several independent states (e.g. unison lanes) through processSample.
+    struct Coefficients
+    {
+        float a1 { 1.0f };
+        float a2 { 0.0f };
+        float a3 { 0.0f };
+        float k { 2.0f };
+    };
+
     void prepare (double newSampleRate) noexcept;
     void reset() noexcept;
 
@@ -23,7 +33,12 @@ public:
     void setKeyTracking (float newKeyTracking) noexcept;
     void setKeyTrackingReferenceHz (float newReferenceHz) noexcept;
 
+    [[nodiscard]] Coefficients computeCoefficients (float keyFrequencyHz) const noexcept;
     float processSample (float input, float keyFrequencyHz) noexcept;
+    float processSample (float input, const Coefficients& coefficients) noexcept;
+
+    // Filters numSamples in place with one set of coefficients, e.g. over a control block.
+    void processBlock (float* samples, int numSamples, const Coefficients& coefficients) noexcept;
 
 private:
     static constexpr float minCutoffHz = 20.0f;
@@ -0,0 +1,77 @@
+#include "OutputStage.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace secretsynth::dsp::mix
+{
+namespace
+{
+// The Pade curve reaches 1 just below 5; clamping the input keeps it monotonic.
+constexpr float padeInputRange = 4.97f;
+constexpr float cubicInputRange = 1.5f;
+constexpr float cubicCoefficient = 4.0f / 27.0f;
+
+template <typename Function>
+void applyBlock (const float* input, float* output, int numSamples, float gain, Function function) noexcept
+{
+    for (int sample = 0; sample < numSamples; ++sample)
+        output[sample] = function (input[sample] * gain);
+}
+} // namespace
+
+void OutputStage::process (const float* input, float* output, int numSamples, float gain) const noexcept
+{
+    if (numSamples <= 0)
+        return;
+
+    if (peak (input, numSamples) * std::abs (gain) < linearThreshold)
+    {
+        applyBlock (input, output, numSamples, gain, [] (float sample) { return sample; });
+        return;
+    }
+
+    switch (saturator)
+    {
+        case Saturator::tanh:
+            applyBlock (input, output, numSamples, gain, saturateTanh);
+            return;
+        case Saturator::cubic:
+            applyBlock (input, output, numSamples, gain, saturateCubic);
+            return;
+        case Saturator::pade:
+        default:
+            applyBlock (input, output, numSamples, gain, saturatePade);
+            return;
+    }
+}
+
+float OutputStage::saturateTanh (float sample) noexcept
+{
+    return std::tanh (sample);
+}
+
+float OutputStage::saturatePade (float sample) noexcept
+{
+    const auto x = std::clamp (sample, -padeInputRange, padeInputRange);
+    const auto x2 = x * x;
+    const auto numerator = x * (135135.0f + x2 * (17325.0f + x2 * (378.0f + x2)));
+    const auto denominator = 135135.0f + x2 * (62370.0f + x2 * (3150.0f + x2 * 28.0f));
+    return std::clamp (numerator / denominator, -1.0f, 1.0f);
+}
+
+float OutputStage::saturateCubic (float sample) noexcept
+{
+    const auto x = std::clamp (sample, -cubicInputRange, cubicInputRange);
+    return x - cubicCoefficient * x * x * x;
+}
+
+float OutputStage::peak (const float* input, int numSamples) noexcept
+{
+    auto result = 0.0f;
+    for (int sample = 0; sample < numSamples; ++sample)
+        result = std::max (result, std::abs (input[sample]));
+
+    return result;
+}
+} // namespace secretsynth::dsp::mix
@@ -0,0 +1,37 @@
+#pragma once
+
+namespace secretsynth::dsp::mix
+{
+// Final gain + saturation stage. Every saturator has unit slope at zero and saturates at +/-1,
+// and each one runs over a whole block in a loop the compiler can vectorize (the exact tanh
+// excepted, which stays a libm call per sample).
+class OutputStage
+{
+public:
+    enum class Saturator
+    {
+        tanh,  // std::tanh, the reference curve
+        pade,  // clamped Lambert continued-fraction tanh, |error| < 1.1e-4
+        cubic  // x - 4x^3/27, hard-limited at |x| = 1.5 where it reaches 1 with zero slope
+    };
+
+    // Blocks whose gained peak stays below this skip saturation: every curve above is within
+    // 1e-4 (relative) of linear there, i.e. well below its knee.
+    static constexpr float linearThreshold = 0.0173f;
+
+    void setSaturator (Saturator newSaturator) noexcept { saturator = newSaturator; }
+    [[nodiscard]] Saturator getSaturator() const noexcept { return saturator; }
+
+    // Writes saturate (input * gain) to output; input and output may alias.
+    void process (const float* input, float* output, int numSamples, float gain) const noexcept;
+
+    [[nodiscard]] static float saturateTanh (float sample) noexcept;
+    [[nodiscard]] static float saturatePade (float sample) noexcept;
+    [[nodiscard]] static float saturateCubic (float sample) noexcept;
+
+    [[nodiscard]] static float peak (const float* input, int numSamples) noexcept;
+
+private:
+    Saturator saturator { Saturator::pade };
+};
+} // namespace secretsynth::dsp::mix
@@ -0,0 +1,65 @@
+#include "StereoMixBus.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace secretsynth::dsp::mix
+{
+namespace
+{
+constexpr float halfPi = 1.57079632679489661923f;
+constexpr float monoFoldGain = 0.70710678f;
+} // namespace
+
+StereoMixBus::PanGains StereoMixBus::constantPowerPan (float pan) noexcept
+{
+    const auto angle = (std::clamp (pan, -1.0f, 1.0f) + 1.0f) * 0.5f * halfPi;
+    return { std::max (0.0f, std::cos (angle)), std::max (0.0f, std::sin (angle)) };
+}
+
+void StereoMixBus::prepare (int maxBlockSize)
+{
+    const auto size = static_cast<std::size_t> (std::max (1, maxBlockSize));
+    left.assign (size, 0.0f);
+    right.assign (size, 0.0f);
+}
+
+void StereoMixBus::clear (int numSamples) noexcept
+{
+    const auto count = std::clamp (numSamples, 0, getCapacity());
+    std::fill_n (left.begin(), count, 0.0f);
+    std::fill_n (right.begin(), count, 0.0f);
+}
+
+void StereoMixBus::applyGainRamp (const float* gains, int numSamples) noexcept
+{
+    numSamples = std::clamp (numSamples, 0, getCapacity());
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
+        left[static_cast<std::size_t> (sample)] *= gains[sample];
+        right[static_cast<std::size_t> (sample)] *= gains[sample];
+    }
+}
+
+void StereoMixBus::renderTo (float* const* channels, int numChannels, int numSamples, float gain) noexcept
+{
+    numSamples = std::clamp (numSamples, 0, getCapacity());
+    if (numChannels <= 0 || numSamples == 0)
+        return;
+
+    if (numChannels == 1)
+    {
+        for (int sample = 0; sample < numSamples; ++sample)
+            left[static_cast<std::size_t> (sample)] += right[static_cast<std::size_t> (sample)];
+
+        outputStage.process (left.data(), channels[0], numSamples, gain * monoFoldGain);
+        return;
+    }
+
+    outputStage.process (left.data(), channels[0], numSamples, gain);
+    outputStage.process (right.data(), channels[1], numSamples, gain);
+
+    for (int channel = 2; channel < numChannels; ++channel)
+        std::fill_n (channels[channel], numSamples, 0.0f);
+}
+} // namespace secretsynth::dsp::mix
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "OutputStage.h"
+
+#include <vector>
+
+namespace secretsynth::dsp::mix
+{
+// Stereo accumulation bus for the voice mix. Voices add into the left/right buffers; renderTo
+// then runs each channel through the output stage (gain + saturator) straight into the host's
+// channel pointers.
+class StereoMixBus
+{
+public:
+    struct PanGains
+    {
+        float left { 0.70710678f };
+        float right { 0.70710678f };
+    };
+
+    // Constant-power pan law; pan is -1 (left) .. 1 (right).
+    [[nodiscard]] static PanGains constantPowerPan (float pan) noexcept;
+
+    void prepare (int maxBlockSize);
+    void clear (int numSamples) noexcept;
+
+    [[nodiscard]] int getCapacity() const noexcept { return static_cast<int> (left.size()); }
+    [[nodiscard]] float* getLeft() noexcept { return left.data(); }
+    [[nodiscard]] float* getRight() noexcept { return right.data(); }
+    [[nodiscard]] OutputStage& getOutputStage() noexcept { return outputStage; }
+
+    // Scales both accumulation buffers by a per-sample gain ramp, e.g. a smoothed output level.
+    void applyGainRamp (const float* gains, int numSamples) noexcept;
+
+    // Writes numSamples of saturated output to channels[0..numChannels). A mono destination gets the
+    // constant-power fold (L + R) * sqrt(1/2); channels past the second are cleared.
+    void renderTo (float* const* channels, int numChannels, int numSamples, float gain) noexcept;
+
+private:
+    OutputStage outputStage;
+    std::vector<float> left;
+    std::vector<float> right;
+};
+} // namespace secretsynth::dsp::mix
@@ -1,7 +1,10 @@
 #include "Modulation.h"
 
 #include <algorithm>
+#include <bit>
+#include <charconv>
 #include <cmath>
+#include <functional>
 #include <sstream>
 
 namespace secretsynth::dsp::mod
@@ -14,6 +17,73 @@ std::uint32_t secondsToSamples (float seconds, double sampleRate) noexcept
 {
     return static_cast<std::uint32_t> (std::max (1.0, std::round (std::max (0.0f, seconds) * sampleRate)));
 }
+
+void writeU16 (std::vector<std::uint8_t>& out, std::uint16_t value)
+{
+    out.push_back (static_cast<std::uint8_t> (value & 0xffu));
+    out.push_back (static_cast<std::uint8_t> ((value >> 8) & 0xffu));
+}
+
+void writeU32 (std::vector<std::uint8_t>& out, std::uint32_t value)
+{
+    for (int shift = 0; shift < 32; shift += 8)
+        out.push_back (static_cast<std::uint8_t> ((value >> shift) & 0xffu));
+}
+
+std::uint16_t readU16 (const std::uint8_t* bytes) noexcept
+{
+    return static_cast<std::uint16_t> (bytes[0] | (bytes[1] << 8));
+}
+
+std::uint32_t readU32 (const std::uint8_t* bytes) noexcept
+{
+    return static_cast<std::uint32_t> (bytes[0])
+         | (static_cast<std::uint32_t> (bytes[1]) << 8)
+         | (static_cast<std::uint32_t> (bytes[2]) << 16)
+         | (static_cast<std::uint32_t> (bytes[3]) << 24);
+}
+
+template <typename Value>
+bool parseNumber (std::string_view text, Value& parsed) noexcept
+{
+    const auto* begin = text.data();
+    const auto* end = begin + text.size();
+    const auto result = std::from_chars (begin, end, parsed);
+    return result.ec == std::errc() && result.ptr == end;
+}
+
+bool parseSource (int raw, Source& source) noexcept
+{
+    if (raw < 0 || raw >= static_cast<int> (Source::count))
+        return false;
+
+    source = static_cast<Source> (raw);
+    return true;
+}
+
+bool parseDestination (int raw, Destination& destination) noexcept
+{
+    if (raw < 0 || raw >= static_cast<int> (Destination::count))
+        return false;
+
+    destination = static_cast<Destination> (raw);
+    return true;
+}
+
+bool nextLine (std::string_view& text, std::string_view& line) noexcept
+{
+    if (text.empty())
+        return false;
+
+    const auto lineEnd = text.find ('\n');
+    line = text.substr (0, lineEnd);
+    text = lineEnd == std::string_view::npos ? std::string_view {} : text.substr (lineEnd + 1);
+
+    if (! line.empty() && line.back() == '\r')
+        line.remove_suffix (1);
+
+    return true;
+}
 } // namespace
 
 void AdsrEnvelope::setSampleRate (double newSampleRate) noexcept
@@ -109,6 +179,14 @@ float AdsrEnvelope::processSample() noexcept
     return currentValue;
 }
 
+float AdsrEnvelope::advance (int numSamples) noexcept
+{
+    for (int sample = 0; sample < numSamples; ++sample)
+        processSample();
+
+    return currentValue;
+}
+
 void Lfo::setSampleRate (double newSampleRate) noexcept
 {
     sampleRate = std::max (1.0, newSampleRate);
@@ -146,10 +224,15 @@ void Lfo::reset() noexcept
 }
 
 float Lfo::processSample() noexcept
+{
+    return advance (1);
+}
+
+float Lfo::advance (int numSamples) noexcept
 {
     const auto frequency = getCurrentFrequencyHz();
     const auto phaseIncrement = frequency / static_cast<float> (sampleRate);
-    phase += phaseIncrement;
+    phase += phaseIncrement * static_cast<float> (numSamples);
     phase -= std::floor (phase);
 
     if (waveform == Waveform::triangle)
@@ -226,6 +309,71 @@ void DestinationSmoother::updateCoefficient() noexcept
     coefficient = static_cast<float> (1.0 - std::exp (-1.0 / (tau * sampleRate)));
 }
 
+void LinearRamp::setSampleRate (double newSampleRate) noexcept
+{
+    sampleRate = std::max (1.0, newSampleRate);
+    setRampTimeSeconds (rampTimeSeconds);
+}
+
+void LinearRamp::setRampTimeSeconds (float newTimeSeconds) noexcept
+{
+    rampTimeSeconds = std::max (0.0f, newTimeSeconds);
+    rampSamples = static_cast<int> (std::lround (static_cast<double> (rampTimeSeconds) * sampleRate));
+}
+
+void LinearRamp::reset (float value) noexcept
+{
+    currentValue = value;
+    targetValue = value;
+    samplesRemaining = 0;
+    step = 0.0f;
+}
+
+void LinearRamp::setTargetValue (float newTarget) noexcept
+{
+    if (std::equal_to<> {} (newTarget, targetValue))
+        return;
+
+    targetValue = newTarget;
+    if (rampSamples <= 0)
+    {
+        reset (newTarget);
+        return;
+    }
+
+    // A retarget mid-ramp starts a fresh ramp from wherever the value is now.
+    samplesRemaining = rampSamples;
+    step = (targetValue - currentValue) / static_cast<float> (rampSamples);
+}
+
+bool LinearRamp::process (float* output, int numSamples) noexcept
+{
+    if (samplesRemaining <= 0 || numSamples <= 0)
+        return false;
+
+    const auto rampCount = std::min (numSamples, samplesRemaining);
+    const auto start = currentValue;
+    for (int sample = 0; sample < rampCount; ++sample)
+        output[sample] = start + step * static_cast<float> (sample + 1);
+
+    samplesRemaining -= rampCount;
+    if (samplesRemaining > 0)
+    {
+        currentValue = output[rampCount - 1];
+        return true;
+    }
+
+    // Land exactly on the target and hold it for the rest of the block.
+    currentValue = targetValue;
+    std::fill (output + rampCount - 1, output + numSamples, targetValue);
+    return true;
+}
+
+ModulationMatrix::ModulationMatrix()
+{
+    routes.reserve (routeCapacity);
+}
+
 void ModulationMatrix::setSampleRate (double newSampleRate) noexcept
 {
     for (auto& smoother : smoothers)
@@ -248,8 +396,32 @@ void ModulationMatrix::addRoute (const Route& route)
     routes.push_back (route);
 }
 
+RouteSet ModulationMatrix::getRouteSet() const noexcept
+{
+    RouteSet routeSet;
+    routeSet.count = std::min (routes.size(), routeCapacity);
+    std::copy_n (routes.begin(), routeSet.count, routeSet.routes.begin());
+    return routeSet;
+}
+
+void ModulationMatrix::setRoutes (const RouteSet& routeSet) noexcept
+{
+    routes.assign (routeSet.routes.begin(), routeSet.routes.begin() + static_cast<std::ptrdiff_t> (std::min (routeSet.count, routeCapacity)));
+}
+
 std::array<float, static_cast<std::size_t> (Destination::count)> ModulationMatrix::process (
     const std::array<float, static_cast<std::size_t> (Source::count)>& sourceValues) noexcept
+{
+    auto destinations = evaluate (sourceValues);
+
+    for (std::size_t i = 0; i < destinations.size(); ++i)
+        destinations[i] = smoothers[i].processSample (destinations[i]);
+
+    return destinations;
+}
+
+std::array<float, static_cast<std::size_t> (Destination::count)> ModulationMatrix::evaluate (
+    const std::array<float, static_cast<std::size_t> (Source::count)>& sourceValues) const noexcept
 {
     std::array<float, static_cast<std::size_t> (Destination::count)> destinations {};
 
@@ -260,13 +432,79 @@ std::array<float, static_cast<std::size_t> (Destination::count)> ModulationMatri
         destinations[toIndex (route.destination)] += source * route.depth;
     }
 
-    for (std::size_t i = 0; i < destinations.size(); ++i)
-        destinations[i] = smoothers[i].processSample (destinations[i]);
-
     return destinations;
 }
 
-std::string ModulationMatrix::serialize() const
+std::vector<std::uint8_t> ModulationMatrix::serialize() const
+{
+    const auto routeCount = std::min (routes.size(), maxSerializedRoutes);
+
+    std::vector<std::uint8_t> data;
+    data.reserve (binaryHeaderSize + routeCount * binaryRouteSize);
+    for (const auto byte : binaryMagic)
+        data.push_back (byte);
+
+    writeU16 (data, binaryFormatVersion);
+    writeU16 (data, static_cast<std::uint16_t> (routeCount));
+
+    for (std::size_t i = 0; i < routeCount; ++i)
+    {
+        const auto& route = routes[i];
+        data.push_back (static_cast<std::uint8_t> (route.source));
+        data.push_back (static_cast<std::uint8_t> (route.destination));
+        data.push_back (route.bipolar ? 1u : 0u);
+        data.push_back (0u);
+        writeU32 (data, std::bit_cast<std::uint32_t> (route.depth));
+    }
+
+    return data;
+}
+
+bool ModulationMatrix::isBinaryRouteData (std::span<const std::uint8_t> data) noexcept
+{
+    return data.size() >= binaryMagic.size() && std::equal (binaryMagic.begin(), binaryMagic.end(), data.begin());
+}
+
+bool ModulationMatrix::deserialize (std::span<const std::uint8_t> data)
+{
+    if (data.size() < binaryHeaderSize || ! isBinaryRouteData (data))
+        return false;
+
+    if (readU16 (data.data() + 4) != binaryFormatVersion)
+        return false;
+
+    const auto routeCount = static_cast<std::size_t> (readU16 (data.data() + 6));
+    if (data.size() != binaryHeaderSize + routeCount * binaryRouteSize)
+        return false;
+
+    std::vector<Route> parsedRoutes;
+    parsedRoutes.reserve (routeCount);
+
+    for (std::size_t i = 0; i < routeCount; ++i)
+    {
+        const auto* record = data.data() + binaryHeaderSize + i * binaryRouteSize;
+
+        Route route;
+        if (! parseSource (record[0], route.source) || ! parseDestination (record[1], route.destination))
+            return false;
+
+        if ((record[2] & ~1u) != 0u)
+            return false;
+
+        route.bipolar = record[2] != 0u;
+        route.depth = std::bit_cast<float> (readU32 (record + 4));
+
+        if (! std::isfinite (route.depth))
+            return false;
+
+        parsedRoutes.push_back (route);
+    }
+
+    routes.assign (parsedRoutes.begin(), parsedRoutes.end());
+    return true;
+}
+
+std::string ModulationMatrix::toDebugText() const
 {
     std::ostringstream stream;
     stream << "schema=" << schemaVersion << "\n";
@@ -283,51 +521,69 @@ std::string ModulationMatrix::serialize() const
     return stream.str();
 }
 
-bool ModulationMatrix::deserialize (std::string_view text)
+bool ModulationMatrix::fromDebugText (std::string_view text)
 {
-    std::istringstream stream { std::string (text) };
-    std::string line;
+    std::string_view line;
 
-    if (! std::getline (stream, line) || line.rfind ("schema=", 0) != 0)
+    std::uint32_t parsedSchema = 0;
+    if (! nextLine (text, line) || ! line.starts_with ("schema=") || ! parseNumber (line.substr (7), parsedSchema))
         return false;
 
-    const auto parsedSchema = std::stoul (line.substr (7));
     if (parsedSchema != schemaVersion)
         return false;
 
-    if (! std::getline (stream, line) || line.rfind ("routes=", 0) != 0)
+    std::size_t routeCount = 0;
+    if (! nextLine (text, line) || ! line.starts_with ("routes=") || ! parseNumber (line.substr (7), routeCount))
         return false;
 
-    const auto routeCount = static_cast<std::size_t> (std::stoul (line.substr (7)));
+    if (routeCount > maxSerializedRoutes)
+        return false;
 
     std::vector<Route> parsedRoutes;
     parsedRoutes.reserve (routeCount);
 
-    while (std::getline (stream, line) && ! line.empty())
+    while (nextLine (text, line) && ! line.empty())
     {
-        std::istringstream lineStream (line);
-        std::string token;
-        std::array<std::string, 4> fields;
-
+        std::array<std::string_view, 4> fields;
         for (std::size_t i = 0; i < fields.size(); ++i)
         {
-            if (! std::getline (lineStream, token, ','))
+            const auto separator = line.find (',');
+            if ((separator == std::string_view::npos) != (i + 1 == fields.size()))
                 return false;
-            fields[i] = token;
+
+            fields[i] = line.substr (0, separator);
+            line = separator == std::string_view::npos ? std::string_view {} : line.substr (separator + 1);
         }
 
+        int rawSource = 0;
+        int rawDestination = 0;
+        int rawBipolar = 0;
+
         Route route;
-        route.source = static_cast<Source> (std::stoi (fields[0]));
-        route.destination = static_cast<Destination> (std::stoi (fields[1]));
-        route.depth = std::stof (fields[2]);
-        route.bipolar = std::stoi (fields[3]) != 0;
+        if (! parseNumber (fields[0], rawSource) || ! parseSource (rawSource, route.source))
+            return false;
+
+        if (! parseNumber (fields[1], rawDestination) || ! parseDestination (rawDestination, route.destination))
+            return false;
+
+        if (! parseNumber (fields[2], route.depth) || ! std::isfinite (route.depth))
+            return false;
+
+        if (! parseNumber (fields[3], rawBipolar))
+            return false;
+
+        route.bipolar = rawBipolar != 0;
+
+        if (parsedRoutes.size() == routeCount)
+            return false;
+
         parsedRoutes.push_back (route);
     }
 
     if (parsedRoutes.size() != routeCount)
         return false;
 
-    routes = std::move (parsedRoutes);
+    routes.assign (parsedRoutes.begin(), parsedRoutes.end());
     return true;
 }
 
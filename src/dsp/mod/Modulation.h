@@ -1,8 +1,11 @@
 #pragma once
 
+#include "../SharedSnapshot.h"
+
 #include <array>
 #include <cstddef>
 #include <cstdint>
+#include <span>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -27,6 +30,9 @@ public:
     void reset() noexcept;
     float processSample() noexcept;
 
+    // Steps the envelope numSamples forward and returns the value at the last one.
+    float advance (int numSamples) noexcept;
+
     [[nodiscard]] float getCurrentValue() const noexcept { return currentValue; }
 
 private:
@@ -82,6 +88,10 @@ public:
 
     float processSample() noexcept;
 
+    // Moves the phase numSamples forward in one step and returns the value there; for callers
+    // that evaluate the LFO at control rate.
+    float advance (int numSamples) noexcept;
+
     [[nodiscard]] float getCurrentValue() const noexcept { return currentValue; }
     [[nodiscard]] float getCurrentFrequencyHz() const noexcept;
 
@@ -143,11 +153,54 @@ private:
     float currentValue { 0.0f };
 };
 
+// Linear ramp to a target over a fixed time, processed a block at a time. process fills a buffer
+// only while ramping; once settled it returns false and getCurrentValue is the block's constant.
+class LinearRamp
+{
+public:
+    void setSampleRate (double newSampleRate) noexcept;
+    void setRampTimeSeconds (float newTimeSeconds) noexcept;
+    void reset (float value) noexcept;
+    void setTargetValue (float newTarget) noexcept;
+
+    [[nodiscard]] bool isRamping() const noexcept { return samplesRemaining > 0; }
+    [[nodiscard]] float getCurrentValue() const noexcept { return currentValue; }
+    [[nodiscard]] float getTargetValue() const noexcept { return targetValue; }
+
+    bool process (float* output, int numSamples) noexcept;
+
+private:
+    double sampleRate { 44100.0 };
+    float rampTimeSeconds { 0.0f };
+    int rampSamples { 0 };
+    int samplesRemaining { 0 };
+    float currentValue { 0.0f };
+    float targetValue { 0.0f };
+    float step { 0.0f };
+};
+
+struct RouteSet;
+
 class ModulationMatrix
 {
 public:
     static constexpr std::uint32_t schemaVersion = 1;
 
+    // Binary route layout: 4-byte magic, u16 format version, u16 route count, then one
+    // fixed 8-byte record per route (u8 source, u8 destination, u8 flags, u8 reserved,
+    // little-endian f32 depth).
+    static constexpr std::array<std::uint8_t, 4> binaryMagic { 'S', 'S', 'M', 'R' };
+    static constexpr std::uint16_t binaryFormatVersion = 1;
+    static constexpr std::size_t binaryHeaderSize = 8;
+    static constexpr std::size_t binaryRouteSize = 8;
+    static constexpr std::size_t maxSerializedRoutes = 0xffff;
+
+    // Route storage is reserved up front and reused across clearRoutes() and loads, so addRoute
+    // only allocates beyond this many routes.
+    static constexpr std::size_t routeCapacity = 32;
+
+    ModulationMatrix();
+
     void setSampleRate (double newSampleRate) noexcept;
     void setDestinationSmoothingTimeSeconds (float timeSeconds) noexcept;
 
@@ -155,11 +208,25 @@ public:
     void addRoute (const Route& route);
     [[nodiscard]] const std::vector<Route>& getRoutes() const noexcept { return routes; }
 
+    // Fixed-size copies of the routes for handing them between threads; routes past
+    // routeCapacity are dropped. setRoutes never allocates.
+    [[nodiscard]] RouteSet getRouteSet() const noexcept;
+    void setRoutes (const RouteSet& routeSet) noexcept;
+
     [[nodiscard]] std::array<float, static_cast<std::size_t> (Destination::count)> process (
         const std::array<float, static_cast<std::size_t> (Source::count)>& sourceValues) noexcept;
 
-    [[nodiscard]] std::string serialize() const;
-    bool deserialize (std::string_view text);
+    // Route sum without destination smoothing; safe to share between voices.
+    [[nodiscard]] std::array<float, static_cast<std::size_t> (Destination::count)> evaluate (
+        const std::array<float, static_cast<std::size_t> (Source::count)>& sourceValues) const noexcept;
+
+    [[nodiscard]] std::vector<std::uint8_t> serialize() const;
+    bool deserialize (std::span<const std::uint8_t> data);
+    [[nodiscard]] static bool isBinaryRouteData (std::span<const std::uint8_t> data) noexcept;
+
+    // Human-readable form for debugging and for reading sessions saved before the binary format.
+    [[nodiscard]] std::string toDebugText() const;
+    bool fromDebugText (std::string_view text);
 
 private:
     static std::size_t toIndex (Source source) noexcept { return static_cast<std::size_t> (source); }
@@ -169,6 +236,15 @@ private:
     std::array<DestinationSmoother, static_cast<std::size_t> (Destination::count)> smoothers;
 };
 
+struct RouteSet
+{
+    std::array<Route, ModulationMatrix::routeCapacity> routes {};
+    std::size_t count { 0 };
+};
+
+// Hands route sets from the message thread to the audio thread without locking the reader.
+using SharedRouteSet = SharedSnapshot<RouteSet>;
+
 class ModulationEngine
 {
 public:
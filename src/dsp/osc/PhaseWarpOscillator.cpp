@@ -1,5 +1,8 @@
 #include "PhaseWarpOscillator.h"
 
+#include "../trace/Trace.h"
+#include "../tuning/PitchTable.h"
+
 namespace secretsynth::dsp::osc
 {
 void PhaseWarpOscillator::prepare (double newSampleRate) noexcept
@@ -21,11 +24,13 @@ void PhaseWarpOscillator::setFrequency (float newFrequencyHz) noexcept
 void PhaseWarpOscillator::setTune (float semitones) noexcept
 {
     tuneSemitones = std::clamp (semitones, -48.0f, 48.0f);
+    tuneRatio = computeTuneRatio();
 }
 
 void PhaseWarpOscillator::setFine (float cents) noexcept
 {
     fineCents = std::clamp (cents, -100.0f, 100.0f);
+    tuneRatio = computeTuneRatio();
 }
 
 void PhaseWarpOscillator::setPdAmount (float amount) noexcept
@@ -58,29 +63,62 @@ float PhaseWarpOscillator::renderSample() noexcept
     const auto oversample = getOversampleFactor();
     const auto frequency = computeEffectiveFrequency();
     const auto phaseStep = frequency / static_cast<float> (sampleRate * oversample);
+    const auto shape = computeWarpShape();
 
     auto accumulated = 0.0f;
     for (int i = 0; i < oversample; ++i)
     {
-        const auto warpedLinear = warpPiecewiseLinear (phase01);
-        const auto warpedCurved = warpCurved (phase01);
-        const auto warped = warpedLinear + (warpedCurved - warpedLinear) * pdShape;
-
-        const auto dry = std::sin (twoPi * phase01);
-        const auto wet = std::sin (twoPi * warped);
-        accumulated += dry + (wet - dry) * mix;
-
+        accumulated += renderWarped (phase01, shape);
         phase01 = wrap01 (phase01 + phaseStep);
     }
 
     return accumulated / static_cast<float> (oversample);
 }
 
+void PhaseWarpOscillator::renderLanes (const float* frequencyHz,
+                                       const float* laneRatios,
+                                       float* lanePhases,
+                                       float* laneOutputs,
+                                       int laneStride,
+                                       int laneCount,
+                                       int numSamples) noexcept
+{
+    SECRETSYNTH_TRACE_SCOPE ("oscillator.renderLanes");
+    const auto oversample = getOversampleFactor();
+    const auto phaseScale = tuneRatio / static_cast<float> (sampleRate * oversample);
+    const auto shape = computeWarpShape();
+
+    for (int lane = 0; lane < laneCount; ++lane)
+    {
+        const auto ratio = laneRatios[lane] * phaseScale;
+        auto* output = laneOutputs + lane * laneStride;
+        auto phase = lanePhases[lane];
+
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            const auto phaseStep = std::max (0.0f, frequencyHz[sample]) * ratio;
+            auto accumulated = 0.0f;
+            for (int i = 0; i < oversample; ++i)
+            {
+                accumulated += renderWarped (phase, shape);
+                phase = wrap01 (phase + phaseStep);
+            }
+
+            output[sample] = accumulated / static_cast<float> (oversample);
+        }
+
+        lanePhases[lane] = phase;
+    }
+}
+
+float PhaseWarpOscillator::computeTuneRatio() const noexcept
+{
+    return tuning::centsToRatio (tuneSemitones * 100.0f + fineCents);
+}
+
 float PhaseWarpOscillator::computeEffectiveFrequency() const noexcept
 {
-    const auto semitoneOffset = tuneSemitones + fineCents * 0.01f;
-    const auto ratio = std::pow (2.0f, semitoneOffset / 12.0f);
-    return baseFrequencyHz * ratio;
+    return baseFrequencyHz * tuneRatio;
 }
 
 int PhaseWarpOscillator::getOversampleFactor() const noexcept
@@ -94,32 +132,48 @@ int PhaseWarpOscillator::getOversampleFactor() const noexcept
     }
 }
 
-float PhaseWarpOscillator::warpPiecewiseLinear (float phase) const noexcept
+PhaseWarpOscillator::WarpShape PhaseWarpOscillator::computeWarpShape() const noexcept
 {
-    const auto center = std::clamp (0.5f + (pdAmount - 0.5f) * 0.9f, 0.05f, 0.95f);
+    const auto minShape = 0.2f;
+    const auto maxShape = 5.0f;
+    const auto curvature = minShape + (maxShape - minShape) * pdAmount;
+    const auto skew = 0.5f + 0.5f * std::sin ((pdShape * 2.0f - 1.0f) * 1.57079632679f);
 
-    if (phase < center)
-        return 0.5f * (phase / center);
+    return {
+        std::clamp (0.5f + (pdAmount - 0.5f) * 0.9f, 0.05f, 0.95f),
+        1.0f + (curvature - 1.0f) * skew,
+        1.0f + (curvature - 1.0f) * (1.0f - skew),
+    };
+}
 
-    return 0.5f + 0.5f * ((phase - center) / (1.0f - center));
+float PhaseWarpOscillator::renderWarped (float phase, const WarpShape& shape) const noexcept
+{
+    const auto warpedLinear = warpPiecewiseLinear (phase, shape);
+    const auto warpedCurved = warpCurved (phase, shape);
+    const auto warped = warpedLinear + (warpedCurved - warpedLinear) * pdShape;
+
+    const auto dry = std::sin (twoPi * phase);
+    const auto wet = std::sin (twoPi * warped);
+    return dry + (wet - dry) * mix;
 }
 
-float PhaseWarpOscillator::warpCurved (float phase) const noexcept
+float PhaseWarpOscillator::warpPiecewiseLinear (float phase, const WarpShape& shape) noexcept
 {
-    const auto minShape = 0.2f;
-    const auto maxShape = 5.0f;
-    const auto curvature = minShape + (maxShape - minShape) * pdAmount;
-    const auto skew = 0.5f + 0.5f * std::sin ((pdShape * 2.0f - 1.0f) * 1.57079632679f);
-    const auto exponentA = 1.0f + (curvature - 1.0f) * skew;
-    const auto exponentB = 1.0f + (curvature - 1.0f) * (1.0f - skew);
+    if (phase < shape.center)
+        return 0.5f * (phase / shape.center);
 
+    return 0.5f + 0.5f * ((phase - shape.center) / (1.0f - shape.center));
+}
+
+float PhaseWarpOscillator::warpCurved (float phase, const WarpShape& shape) noexcept
+{
     if (phase < 0.5f)
-        return 0.5f * std::pow (phase * 2.0f, exponentA);
+        return 0.5f * std::pow (phase * 2.0f, shape.exponentA);
 
-    return 1.0f - 0.5f * std::pow ((1.0f - phase) * 2.0f, exponentB);
+    return 1.0f - 0.5f * std::pow ((1.0f - phase) * 2.0f, shape.exponentB);
 }
 
-float PhaseWarpOscillator::wrap01 (float value) const noexcept
+float PhaseWarpOscillator::wrap01 (float value) noexcept
 {
     value -= std::floor (value);
     if (value >= 1.0f)
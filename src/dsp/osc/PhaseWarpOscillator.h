@@ -29,20 +29,37 @@ public:
     [[nodiscard]] float getFrequencyHz() const noexcept;
     [[nodiscard]] float renderSample() noexcept;
 
+    // Renders numSamples for each of laneCount unison lanes sharing this oscillator's shape, tune
+    // and quality settings. Lane i runs at frequencyHz[sample] * laneRatios[i] from lanePhases[i],
+    // which is advanced in place, and writes to laneOutputs + i * laneStride; this oscillator's own
+    // frequency and phase are left untouched. The shape terms are computed once per call.
+    void renderLanes (const float* frequencyHz, const float* laneRatios, float* lanePhases, float* laneOutputs, int laneStride, int laneCount, int numSamples) noexcept;
+
 private:
     static constexpr float twoPi = 6.28318530717958647692f;
 
+    struct WarpShape
+    {
+        float center { 0.5f };
+        float exponentA { 1.0f };
+        float exponentB { 1.0f };
+    };
+
+    [[nodiscard]] float computeTuneRatio() const noexcept;
     [[nodiscard]] float computeEffectiveFrequency() const noexcept;
     [[nodiscard]] int getOversampleFactor() const noexcept;
-    [[nodiscard]] float warpPiecewiseLinear (float phase01) const noexcept;
-    [[nodiscard]] float warpCurved (float phase01) const noexcept;
-    [[nodiscard]] float wrap01 (float value) const noexcept;
+    [[nodiscard]] WarpShape computeWarpShape() const noexcept;
+    [[nodiscard]] float renderWarped (float phase, const WarpShape& shape) const noexcept;
+    [[nodiscard]] static float warpPiecewiseLinear (float phase01, const WarpShape& shape) noexcept;
+    [[nodiscard]] static float warpCurved (float phase01, const WarpShape& shape) noexcept;
+    [[nodiscard]] static float wrap01 (float value) noexcept;
 
     double sampleRate { 44100.0 };
 
     float baseFrequencyHz { 220.0f };
     float tuneSemitones { 0.0f };
     float fineCents { 0.0f };
+    float tuneRatio { 1.0f }; // cached by setTune/setFine
     float pdAmount { 0.0f };
     float pdShape { 0.0f };
     float mix { 1.0f };
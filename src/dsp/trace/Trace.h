@@ -0,0 +1,171 @@
+#pragma once
+
+// SECRETSYNTH_TRACE_SCOPE ("name") records when the enclosing scope began and ended. It compiles
+// to nothing unless SECRETSYNTH_TRACING is defined to 1 (CMake option SECRETSYNTH_ENABLE_TRACING).
+// Names must be string literals. writeChromeTrace() dumps the recorded events as Chrome
+// trace-event JSON for chrome://tracing or Perfetto.
+#if SECRETSYNTH_TRACING
+
+    #include <algorithm>
+    #include <array>
+    #include <atomic>
+    #include <chrono>
+    #include <cstddef>
+    #include <cstdint>
+    #include <limits>
+    #include <memory>
+    #include <mutex>
+    #include <ostream>
+    #include <utility>
+    #include <vector>
+
+    #define SECRETSYNTH_TRACE_CONCAT_INNER(a, b) a##b
+    #define SECRETSYNTH_TRACE_CONCAT(a, b) SECRETSYNTH_TRACE_CONCAT_INNER (a, b)
+    #define SECRETSYNTH_TRACE_SCOPE(name) \
+        const ::secretsynth::dsp::trace::ScopedEvent SECRETSYNTH_TRACE_CONCAT (secretsynthTraceScope, __LINE__) { name }
+
+namespace secretsynth::dsp::trace
+{
+struct Event
+{
+    const char* name { nullptr };
+    std::uint64_t beginNs { 0 };
+    std::uint64_t endNs { 0 };
+};
+
+[[nodiscard]] inline std::uint64_t nowNs() noexcept
+{
+    return static_cast<std::uint64_t> (
+        std::chrono::duration_cast<std::chrono::nanoseconds> (std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// One thread's events. Only the owning thread records; when full, the oldest events are overwritten.
+class ThreadBuffer
+{
+public:
+    static constexpr std::size_t capacity = std::size_t { 1 } << 16;
+
+    explicit ThreadBuffer (std::uint32_t newThreadId) noexcept : threadId (newThreadId) {}
+
+    void record (const Event& event) noexcept
+    {
+        const auto index = written.load (std::memory_order_relaxed);
+        events[index % capacity] = event;
+        written.store (index + 1, std::memory_order_release);
+    }
+
+    // Any thread. Events recorded while copying may be missing or, once the buffer wraps, torn.
+    [[nodiscard]] std::vector<Event> copyEvents() const
+    {
+        const auto end = written.load (std::memory_order_acquire);
+        const auto begin = end > capacity ? end - capacity : 0;
+
+        std::vector<Event> copy;
+        copy.reserve (static_cast<std::size_t> (end - begin));
+        for (auto index = begin; index < end; ++index)
+            copy.push_back (events[index % capacity]);
+
+        return copy;
+    }
+
+    [[nodiscard]] std::uint32_t getThreadId() const noexcept { return threadId; }
+
+private:
+    std::uint32_t threadId;
+    std::atomic<std::uint64_t> written { 0 };
+    std::array<Event, capacity> events {};
+};
+
+// Owns every thread's buffer for the life of the process, so events outlive their threads.
+class Registry
+{
+public:
+    [[nodiscard]] static Registry& get()
+    {
+        static Registry registry;
+        return registry;
+    }
+
+    // The first call on each thread allocates that thread's buffer; later calls are wait-free.
+    [[nodiscard]] ThreadBuffer& getThreadBuffer()
+    {
+        thread_local ThreadBuffer* buffer = nullptr;
+        if (buffer == nullptr)
+        {
+            const std::lock_guard lock { bufferLock };
+            buffers.push_back (std::make_unique<ThreadBuffer> (static_cast<std::uint32_t> (buffers.size())));
+            buffer = buffers.back().get();
+        }
+
+        return *buffer;
+    }
+
+    // Writes every recorded event as a complete ("X") event, timed from the earliest one.
+    void writeChromeTrace (std::ostream& output)
+    {
+        std::vector<std::pair<std::uint32_t, std::vector<Event>>> threads;
+        {
+            const std::lock_guard lock { bufferLock };
+            for (const auto& buffer : buffers)
+                threads.emplace_back (buffer->getThreadId(), buffer->copyEvents());
+        }
+
+        auto originNs = std::numeric_limits<std::uint64_t>::max();
+        for (const auto& thread : threads)
+            for (const auto& event : thread.second)
+                originNs = std::min (originNs, event.beginNs);
+
+        const auto microseconds = [] (std::uint64_t ns) { return static_cast<double> (ns) / 1000.0; };
+
+        output << "{\"traceEvents\":[";
+        auto first = true;
+        for (const auto& [threadId, events] : threads)
+        {
+            for (const auto& event : events)
+            {
+                output << (first ? "\n" : ",\n") << "{\"name\":\"";
+                for (const auto* character = event.name; *character != '\0'; ++character)
+                    output << (*character == '"' || *character == '\\' ? "\\" : "") << *character;
+
+                output << "\",\"cat\":\"secretsynth\",\"ph\":\"X\",\"pid\":1,\"tid\":" << threadId
+                       << ",\"ts\":" << microseconds (event.beginNs - originNs)
+                       << ",\"dur\":" << microseconds (event.endNs - event.beginNs) << "}";
+                first = false;
+            }
+        }
+
+        output << "\n],\"displayTimeUnit\":\"ns\"}\n";
+    }
+
+private:
+    Registry() = default;
+
+    std::mutex bufferLock;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+};
+
+class ScopedEvent
+{
+public:
+    explicit ScopedEvent (const char* newName) noexcept : name (newName), beginNs (nowNs()) {}
+    ~ScopedEvent() { Registry::get().getThreadBuffer().record ({ name, beginNs, nowNs() }); }
+
+    ScopedEvent (const ScopedEvent&) = delete;
+    ScopedEvent& operator= (const ScopedEvent&) = delete;
+
+private:
+    const char* name;
+    std::uint64_t beginNs;
+};
+
+inline void writeChromeTrace (std::ostream& output)
+{
+    Registry::get().writeChromeTrace (output);
+}
+} // namespace secretsynth::dsp::trace
+
+#else
+
+    #define SECRETSYNTH_TRACE_SCOPE(name) static_cast<void> (0)
+
+#endif
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+namespace secretsynth::dsp::tuning
+{
+// Compile-time pitch tables. Note frequencies and cents ratios are built once by the compiler, so
+// note starts and pitch modulation never call pow/exp2 on the audio thread.
+namespace detail
+{
+// 2^x for x in [0, 1] from the exp power series; constexpr because std::exp2 is not.
+constexpr double exp2UnitInterval (double x) noexcept
+{
+    constexpr double ln2 = 0.69314718055994530942;
+    const auto y = x * ln2;
+
+    auto term = 1.0;
+    auto sum = 1.0;
+    for (int k = 1; k < 30; ++k)
+    {
+        term *= y / static_cast<double> (k);
+        sum += term;
+    }
+
+    return sum;
+}
+
+constexpr double exp2Octaves (int octaves) noexcept
+{
+    auto result = 1.0;
+    for (; octaves > 0; --octaves)
+        result *= 2.0;
+    for (; octaves < 0; ++octaves)
+        result *= 0.5;
+
+    return result;
+}
+} // namespace detail
+
+inline constexpr int midiNoteCount = 128;
+inline constexpr float referenceFrequencyHz = 440.0f;
+inline constexpr int referenceMidiNote = 69;
+
+inline constexpr std::array<float, midiNoteCount> equalTemperament = []
+{
+    std::array<float, midiNoteCount> table {};
+    for (int note = 0; note < midiNoteCount; ++note)
+    {
+        const auto semitones = note - referenceMidiNote;
+        const auto octave = (semitones >= 0 ? semitones : semitones - 11) / 12;
+        const auto step = semitones - octave * 12;
+        table[static_cast<std::size_t> (note)] = static_cast<float> (
+            referenceFrequencyHz * detail::exp2Octaves (octave) * detail::exp2UnitInterval (step / 12.0));
+    }
+
+    return table;
+}();
+
+// centsToRatio covers +/- maxRatioOctaves; one-cent steps with linear interpolation keep the
+// error below float precision.
+inline constexpr int centsPerOctave = 1200;
+inline constexpr int maxRatioOctaves = 8;
+
+inline constexpr std::array<float, centsPerOctave + 1> octaveCentsRatios = []
+{
+    std::array<float, centsPerOctave + 1> table {};
+    for (int cents = 0; cents <= centsPerOctave; ++cents)
+        table[static_cast<std::size_t> (cents)] = static_cast<float> (detail::exp2UnitInterval (cents / static_cast<double> (centsPerOctave)));
+
+    return table;
+}();
+
+inline constexpr std::array<float, 2 * maxRatioOctaves + 1> octaveRatios = []
+{
+    std::array<float, 2 * maxRatioOctaves + 1> table {};
+    for (int octave = -maxRatioOctaves; octave <= maxRatioOctaves; ++octave)
+        table[static_cast<std::size_t> (octave + maxRatioOctaves)] = static_cast<float> (detail::exp2Octaves (octave));
+
+    return table;
+}();
+
+[[nodiscard]] inline float midiNoteToFrequency (int midiNote) noexcept
+{
+    return equalTemperament[static_cast<std::size_t> (std::clamp (midiNote, 0, midiNoteCount - 1))];
+}
+
+[[nodiscard]] inline float centsToRatio (float cents) noexcept
+{
+    constexpr auto maxCents = static_cast<float> (maxRatioOctaves * centsPerOctave);
+    const auto clamped = std::clamp (cents, -maxCents, maxCents);
+    const auto octave = static_cast<int> (std::floor (clamped * (1.0f / static_cast<float> (centsPerOctave))));
+    const auto withinOctave = std::clamp (clamped - static_cast<float> (octave * centsPerOctave), 0.0f, static_cast<float> (centsPerOctave));
+    const auto step = std::min (static_cast<int> (withinOctave), centsPerOctave - 1);
+    const auto fraction = withinOctave - static_cast<float> (step);
+
+    const auto lower = octaveCentsRatios[static_cast<std::size_t> (step)];
+    const auto upper = octaveCentsRatios[static_cast<std::size_t> (step + 1)];
+    return octaveRatios[static_cast<std::size_t> (octave + maxRatioOctaves)] * (lower + (upper - lower) * fraction);
+}
+
+[[nodiscard]] inline float octavesToRatio (float octaves) noexcept
+{
+    return centsToRatio (octaves * static_cast<float> (centsPerOctave));
+}
+} // namespace secretsynth::dsp::tuning
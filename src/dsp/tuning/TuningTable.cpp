@@ -0,0 +1,298 @@
+#include "TuningTable.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+
+namespace secretsynth::dsp::tuning
+{
+namespace
+{
+constexpr std::size_t maxScaleDegrees = 4096;
+constexpr std::size_t maxMappingSize = 4096;
+constexpr int unmappedKey = -1;
+
+// Yields the non-comment lines of a Scala file with surrounding whitespace trimmed.
+class ScalaLineReader
+{
+public:
+    explicit ScalaLineReader (std::string_view newText) noexcept : text (newText) {}
+
+    [[nodiscard]] std::optional<std::string_view> next() noexcept
+    {
+        while (position <= text.size())
+        {
+            const auto end = std::min (text.find ('\n', position), text.size());
+            auto line = trim (text.substr (position, end - position));
+            position = end + 1;
+
+            if (! line.empty() && line.front() == '!')
+                continue;
+
+            return line;
+        }
+
+        return std::nullopt;
+    }
+
+    // Skips blank lines as well; numeric fields never sit on one.
+    [[nodiscard]] std::optional<std::string_view> nextToken() noexcept
+    {
+        for (auto line = next(); line.has_value(); line = next())
+        {
+            if (! line->empty())
+                return line->substr (0, line->find_first_of (" \t"));
+        }
+
+        return std::nullopt;
+    }
+
+private:
+    static std::string_view trim (std::string_view line) noexcept
+    {
+        const auto first = line.find_first_not_of (" \t\r");
+        if (first == std::string_view::npos)
+            return {};
+
+        return line.substr (first, line.find_last_not_of (" \t\r") - first + 1);
+    }
+
+    std::string_view text;
+    std::size_t position { 0 };
+};
+
+std::optional<std::int64_t> parseInteger (std::string_view token) noexcept
+{
+    std::int64_t value = 0;
+    const auto* end = token.data() + token.size();
+    const auto [last, error] = std::from_chars (token.data(), end, value);
+    if (error != std::errc {} || last != end)
+        return std::nullopt;
+
+    return value;
+}
+
+// Plain decimal ("-12.5", "100.", ".25"); locale-independent, unlike strtod.
+std::optional<double> parseDecimal (std::string_view token) noexcept
+{
+    auto sign = 1.0;
+    if (! token.empty() && (token.front() == '-' || token.front() == '+'))
+    {
+        sign = token.front() == '-' ? -1.0 : 1.0;
+        token.remove_prefix (1);
+    }
+
+    auto value = 0.0;
+    auto scale = 1.0;
+    auto seenPoint = false;
+    auto seenDigit = false;
+    for (const auto character : token)
+    {
+        if (character == '.' && ! seenPoint)
+        {
+            seenPoint = true;
+        }
+        else if (character >= '0' && character <= '9')
+        {
+            seenDigit = true;
+            if (seenPoint)
+            {
+                scale *= 0.1;
+                value += (character - '0') * scale;
+            }
+            else
+            {
+                value = value * 10.0 + (character - '0');
+            }
+        }
+        else
+        {
+            return std::nullopt;
+        }
+    }
+
+    if (! seenDigit)
+        return std::nullopt;
+
+    return sign * value;
+}
+
+// A scale pitch is cents when it contains a period, otherwise a ratio "n/d" or an integer "n".
+std::optional<double> parsePitchCents (std::string_view token) noexcept
+{
+    if (token.find ('.') != std::string_view::npos)
+        return parseDecimal (token);
+
+    const auto slash = token.find ('/');
+    const auto numerator = parseInteger (token.substr (0, slash));
+    const auto denominator = slash == std::string_view::npos ? std::optional<std::int64_t> { 1 } : parseInteger (token.substr (slash + 1));
+    if (! numerator.has_value() || ! denominator.has_value() || *numerator <= 0 || *denominator <= 0)
+        return std::nullopt;
+
+    return 1200.0 * std::log2 (static_cast<double> (*numerator) / static_cast<double> (*denominator));
+}
+
+std::int64_t floorDivide (std::int64_t value, std::int64_t divisor) noexcept
+{
+    const auto quotient = value / divisor;
+    return (value % divisor != 0 && value < 0) ? quotient - 1 : quotient;
+}
+
+template <typename Parser>
+auto parseNext (ScalaLineReader& reader, Parser parser) noexcept -> decltype (parser (std::string_view {}))
+{
+    const auto token = reader.nextToken();
+    if (! token.has_value())
+        return std::nullopt;
+
+    return parser (*token);
+}
+
+struct Scale
+{
+    std::vector<double> pitchCents; // degrees 1..n; the last one is the period
+
+    [[nodiscard]] double degreeCents (std::int64_t degree) const noexcept
+    {
+        const auto size = static_cast<std::int64_t> (pitchCents.size());
+        const auto periods = floorDivide (degree, size);
+        const auto step = degree - periods * size;
+        return static_cast<double> (periods) * pitchCents.back() + (step == 0 ? 0.0 : pitchCents[static_cast<std::size_t> (step - 1)]);
+    }
+};
+
+struct KeyboardMapping
+{
+    int firstNote { 0 };
+    int lastNote { midiNoteCount - 1 };
+    int middleNote { 60 };
+    int referenceNote { referenceMidiNote };
+    double referenceFrequencyHz { tuning::referenceFrequencyHz };
+    std::int64_t formalOctaveDegree { 0 }; // 0 uses the scale's period
+    std::vector<int> keys; // scale degree per key, or unmappedKey; empty maps keys linearly
+};
+
+std::optional<Scale> parseScale (std::string_view text)
+{
+    ScalaLineReader reader { text };
+    if (! reader.next().has_value()) // description
+        return std::nullopt;
+
+    const auto count = parseNext (reader, parseInteger);
+    if (! count.has_value() || *count < 1 || *count > static_cast<std::int64_t> (maxScaleDegrees))
+        return std::nullopt;
+
+    Scale scale;
+    scale.pitchCents.reserve (static_cast<std::size_t> (*count));
+    for (std::int64_t degree = 0; degree < *count; ++degree)
+    {
+        const auto cents = parseNext (reader, parsePitchCents);
+        if (! cents.has_value() || ! std::isfinite (*cents))
+            return std::nullopt;
+
+        scale.pitchCents.push_back (*cents);
+    }
+
+    if (scale.pitchCents.back() <= 0.0)
+        return std::nullopt;
+
+    return scale;
+}
+
+std::optional<KeyboardMapping> parseKeyboardMapping (std::string_view text)
+{
+    ScalaLineReader reader { text };
+    const auto size = parseNext (reader, parseInteger);
+    const auto first = parseNext (reader, parseInteger);
+    const auto last = parseNext (reader, parseInteger);
+    const auto middle = parseNext (reader, parseInteger);
+    const auto reference = parseNext (reader, parseInteger);
+    const auto frequency = parseNext (reader, parseDecimal);
+    const auto octaveDegree = parseNext (reader, parseInteger);
+
+    const auto isNote = [] (const std::optional<std::int64_t>& note) { return note.has_value() && *note >= 0 && *note < midiNoteCount; };
+    if (! size.has_value() || *size < 0 || *size > static_cast<std::int64_t> (maxMappingSize)
+        || ! isNote (first) || ! isNote (last) || ! isNote (middle) || ! isNote (reference)
+        || ! frequency.has_value() || ! (*frequency > 0.0) || ! octaveDegree.has_value() || *octaveDegree < 0)
+        return std::nullopt;
+
+    KeyboardMapping mapping;
+    mapping.firstNote = static_cast<int> (*first);
+    mapping.lastNote = static_cast<int> (*last);
+    mapping.middleNote = static_cast<int> (*middle);
+    mapping.referenceNote = static_cast<int> (*reference);
+    mapping.referenceFrequencyHz = *frequency;
+    mapping.formalOctaveDegree = *octaveDegree;
+
+    // Entries missing from the end of the file leave their keys unmapped.
+    mapping.keys.assign (static_cast<std::size_t> (*size), unmappedKey);
+    for (auto& key : mapping.keys)
+    {
+        const auto token = reader.nextToken();
+        if (! token.has_value())
+            break;
+
+        if (*token == "x" || *token == "X")
+            continue;
+
+        const auto degree = parseInteger (*token);
+        if (! degree.has_value() || *degree < 0 || *degree > static_cast<std::int64_t> (maxScaleDegrees * 128))
+            return std::nullopt;
+
+        key = static_cast<int> (*degree);
+    }
+
+    return mapping;
+}
+
+std::optional<double> noteCents (const Scale& scale, const KeyboardMapping& mapping, int midiNote) noexcept
+{
+    if (midiNote < mapping.firstNote || midiNote > mapping.lastNote)
+        return std::nullopt;
+
+    const auto offset = static_cast<std::int64_t> (midiNote - mapping.middleNote);
+    if (mapping.keys.empty())
+        return scale.degreeCents (offset);
+
+    const auto size = static_cast<std::int64_t> (mapping.keys.size());
+    const auto repeats = floorDivide (offset, size);
+    const auto degree = mapping.keys[static_cast<std::size_t> (offset - repeats * size)];
+    if (degree == unmappedKey)
+        return std::nullopt;
+
+    const auto formalOctave = mapping.formalOctaveDegree == 0 ? scale.pitchCents.back() : scale.degreeCents (mapping.formalOctaveDegree);
+    return static_cast<double> (repeats) * formalOctave + scale.degreeCents (degree);
+}
+} // namespace
+
+bool TuningTable::loadScala (std::string_view scaleText, std::string_view keyboardMappingText)
+{
+    const auto scale = parseScale (scaleText);
+    const auto mapping = keyboardMappingText.empty() ? std::optional<KeyboardMapping> { KeyboardMapping {} } : parseKeyboardMapping (keyboardMappingText);
+    if (! scale.has_value() || ! mapping.has_value())
+        return false;
+
+    const auto referenceCents = noteCents (*scale, *mapping, mapping->referenceNote);
+    if (! referenceCents.has_value())
+        return false;
+
+    std::array<float, midiNoteCount> built {};
+    for (int note = 0; note < midiNoteCount; ++note)
+    {
+        const auto cents = noteCents (*scale, *mapping, note);
+        if (! cents.has_value())
+            continue;
+
+        const auto frequency = mapping->referenceFrequencyHz * std::exp2 ((*cents - *referenceCents) / 1200.0);
+        if (! std::isfinite (frequency))
+            return false;
+
+        built[static_cast<std::size_t> (note)] = static_cast<float> (frequency);
+    }
+
+    frequencies = built;
+    return true;
+}
+} // namespace secretsynth::dsp::tuning
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "../SharedSnapshot.h"
+#include "PitchTable.h"
+
+#include <array>
+#include <string_view>
+
+namespace secretsynth::dsp::tuning
+{
+// Frequency for every MIDI note, precomputed off the audio thread. Defaults to twelve-tone equal
+// temperament at A4 = 440 Hz; keys a keyboard mapping leaves unmapped have frequency 0.
+class TuningTable
+{
+public:
+    [[nodiscard]] float getFrequency (int midiNote) const noexcept
+    {
+        return midiNote >= 0 && midiNote < midiNoteCount ? frequencies[static_cast<std::size_t> (midiNote)] : 0.0f;
+    }
+
+    [[nodiscard]] bool isMapped (int midiNote) const noexcept { return getFrequency (midiNote) > 0.0f; }
+
+    // Builds the table from Scala scale (.scl) text and optional keyboard mapping (.kbm) text.
+    // Without a mapping, note 60 is scale degree 0 and note 69 sounds at 440 Hz. Returns false and
+    // leaves the table unchanged if either file is malformed.
+    bool loadScala (std::string_view scaleText, std::string_view keyboardMappingText = {});
+
+private:
+    std::array<float, midiNoteCount> frequencies { equalTemperament };
+};
+
+// Hands tables from the message thread to the audio thread without locking the reader.
+using SharedTuningTable = SharedSnapshot<TuningTable>;
+} // namespace secretsynth::dsp::tuning
@@ -0,0 +1,204 @@
+#include "RenderThreadPool.h"
+
+#include <algorithm>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
+#endif
+
+#if defined(_WIN32)
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+#elif defined(__APPLE__)
+    #include <mach/mach.h>
+    #include <mach/mach_time.h>
+    #include <mach/thread_policy.h>
+    #include <pthread.h>
+#else
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+namespace secretsynth::dsp::voice
+{
+namespace
+{
+constexpr std::uint64_t jobFieldMask = 0xffff;
+constexpr int countShift = 16;
+constexpr int batchShift = 32;
+
+void cpuRelax() noexcept
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile ("yield");
+#endif
+}
+} // namespace
+
+RenderThreadPool::RenderThreadPool (int workerCount, double callbackPeriodSeconds)
+    : callbackPeriod (std::max (0.0, callbackPeriodSeconds))
+{
+    workerCount = std::max (0, workerCount);
+    workers.reserve (static_cast<std::size_t> (workerCount));
+
+    // Workers are left to the scheduler: every plugin instance has its own pool, and fixed core
+    // assignments would stack the instances' workers on the same cores, next to the host's threads.
+    for (int index = 0; index < workerCount; ++index)
+        workers.emplace_back ([this] { workerLoop(); });
+}
+
+RenderThreadPool::~RenderThreadPool()
+{
+    stopping.store (true, std::memory_order_release);
+    wakeSignal.fetch_add (1, std::memory_order_release);
+    wakeSignal.notify_all();
+
+    for (auto& worker : workers)
+        worker.join();
+}
+
+void RenderThreadPool::run (std::size_t jobCount, JobFunction function, void* context, std::chrono::nanoseconds maxWait) noexcept
+{
+    if (jobCount == 0 || function == nullptr)
+        return;
+
+    deadline = Clock::now() + std::clamp (maxWait, std::chrono::nanoseconds::zero(), std::chrono::nanoseconds (std::chrono::hours (1)));
+    outOfTime.store (false, std::memory_order_relaxed);
+
+    if (workers.empty() || jobCount == 1 || jobCount > maxJobsPerBatch)
+    {
+        for (std::size_t index = 0; index < jobCount; ++index)
+            function (context, index);
+        return;
+    }
+
+    jobFunction = function;
+    jobContext = context;
+    completedJobs.store (0, std::memory_order_relaxed);
+
+    ++batch;
+    work.store ((static_cast<std::uint64_t> (batch) << batchShift) | (static_cast<std::uint64_t> (jobCount) << countShift),
+                std::memory_order_release);
+
+    wakeSignal.fetch_add (1, std::memory_order_release);
+    wakeSignal.notify_all();
+
+    drainJobs();
+
+    // Every job no worker had claimed has run above, so what is left is already running on a
+    // worker and bounded by the deadline. Spin briefly, then sleep until the last job reports so
+    // a worker sharing this core is not starved by the wait.
+    auto spins = 0;
+    for (auto done = completedJobs.load (std::memory_order_acquire); done < jobCount; done = completedJobs.load (std::memory_order_acquire))
+    {
+        if (spins++ < spinIterations)
+            cpuRelax();
+        else
+            completedJobs.wait (done, std::memory_order_acquire);
+    }
+}
+
+bool RenderThreadPool::isOutOfTime() noexcept
+{
+    if (outOfTime.load (std::memory_order_relaxed))
+        return true;
+
+    if (Clock::now() < deadline)
+        return false;
+
+    outOfTime.store (true, std::memory_order_relaxed);
+    return true;
+}
+
+void RenderThreadPool::workerLoop() noexcept
+{
+    raiseWorkerPriority();
+
+    auto seen = wakeSignal.load (std::memory_order_acquire);
+
+    while (! stopping.load (std::memory_order_acquire))
+    {
+        drainJobs();
+
+        auto spins = 0;
+        while (wakeSignal.load (std::memory_order_acquire) == seen && spins++ < spinIterations)
+            cpuRelax();
+
+        wakeSignal.wait (seen, std::memory_order_acquire);
+        seen = wakeSignal.load (std::memory_order_acquire);
+    }
+}
+
+void RenderThreadPool::raiseWorkerPriority() const noexcept
+{
+    // Failures are ignored: without the privilege the worker simply keeps its default priority.
+#if defined(_WIN32)
+    SetThreadPriority (GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+#elif defined(__APPLE__)
+    if (callbackPeriod > 0.0)
+    {
+        mach_timebase_info_data_t timebase {};
+        mach_timebase_info (&timebase);
+        const auto toAbsoluteTime = [&timebase] (double seconds)
+        {
+            return static_cast<std::uint32_t> (seconds * 1.0e9 * timebase.denom / timebase.numer);
+        };
+
+        // A worker gets at most half of each callback period and must finish within the period.
+        thread_time_constraint_policy_data_t policy {};
+        policy.period = toAbsoluteTime (callbackPeriod);
+        policy.computation = toAbsoluteTime (callbackPeriod * 0.5);
+        policy.constraint = toAbsoluteTime (callbackPeriod);
+        policy.preemptible = 1;
+
+        if (thread_policy_set (pthread_mach_thread_np (pthread_self()),
+                               THREAD_TIME_CONSTRAINT_POLICY,
+                               reinterpret_cast<thread_policy_t> (&policy),
+                               THREAD_TIME_CONSTRAINT_POLICY_COUNT)
+            == KERN_SUCCESS)
+            return;
+    }
+
+    pthread_set_qos_class_self_np (QOS_CLASS_USER_INTERACTIVE, 0);
+#else
+    // The lowest FIFO priority already outranks every ordinary thread, and stays below the
+    // host's own audio threads.
+    sched_param parameters {};
+    parameters.sched_priority = sched_get_priority_min (SCHED_FIFO);
+    pthread_setschedparam (pthread_self(), SCHED_FIFO, &parameters);
+#endif
+}
+
+void RenderThreadPool::drainJobs() noexcept
+{
+    auto current = work.load (std::memory_order_acquire);
+
+    for (;;)
+    {
+        const auto index = current & jobFieldMask;
+        const auto count = (current >> countShift) & jobFieldMask;
+        if (index >= count)
+            return;
+
+        if (! work.compare_exchange_weak (current, current + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+            continue;
+
+        // The batch cannot complete (and be replaced) before this job is counted, so the
+        // function and context read here belong to the batch the claim came from.
+        jobFunction (jobContext, static_cast<std::size_t> (index));
+        if (completedJobs.fetch_add (1, std::memory_order_release) + 1 == count)
+            completedJobs.notify_one();
+
+        current = work.load (std::memory_order_acquire);
+    }
+}
+} // namespace secretsynth::dsp::voice
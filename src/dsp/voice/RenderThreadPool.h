@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace secretsynth::dsp::voice
+{
+// Small pool of render workers for the audio thread. run() publishes a batch of jobs, the workers
+// and the calling thread claim them lock-free from a shared counter, and the caller returns once
+// every job has finished. run() never allocates or takes a lock; idle workers spin briefly and
+// then sleep on an atomic wait, so waking them costs at most one futex wake per batch.
+//
+// Workers ask for the platform's realtime scheduling (SCHED_FIFO, a Mach time-constraint policy
+// or TIME_CRITICAL) so a worker holding a job cannot be preempted by ordinary threads while the
+// audio thread waits for it. Where that is not permitted they keep the default priority.
+class RenderThreadPool
+{
+public:
+    using JobFunction = void (*) (void* context, std::size_t jobIndex) noexcept;
+
+    static constexpr std::size_t maxJobsPerBatch = 0xffff;
+
+    // Starts workerCount threads (0 runs everything on the caller). callbackPeriodSeconds is the
+    // audio callback period the workers serve; macOS sizes their time-constraint policy from it.
+    explicit RenderThreadPool (int workerCount, double callbackPeriodSeconds = 0.0);
+    ~RenderThreadPool();
+
+    RenderThreadPool (const RenderThreadPool&) = delete;
+    RenderThreadPool& operator= (const RenderThreadPool&) = delete;
+
+    [[nodiscard]] int getWorkerCount() const noexcept { return static_cast<int> (workers.size()); }
+
+    // Runs function (context, 0..jobCount-1) across the pool. Jobs must not depend on each other.
+    // Jobs no worker has picked up yet run on the calling thread. Once maxWait has passed since the
+    // call, isOutOfTime() returns true: long jobs should poll it and cut their work short, so the
+    // caller waits at most maxWait plus the step a job was in the middle of.
+    void run (std::size_t jobCount, JobFunction function, void* context, std::chrono::nanoseconds maxWait) noexcept;
+
+    // From inside a job: true once the current run() has used up its maxWait.
+    [[nodiscard]] bool isOutOfTime() noexcept;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr int spinIterations = 2048;
+
+    void workerLoop() noexcept;
+    void raiseWorkerPriority() const noexcept;
+    void drainJobs() noexcept;
+
+    // One word holds batch id (32 bits), job count (16) and next job index (16), so a claim can
+    // never pair an index from one batch with the job count of another.
+    std::atomic<std::uint64_t> work { 0 };
+    std::atomic<std::uint32_t> completedJobs { 0 };
+    std::atomic<std::uint32_t> wakeSignal { 0 };
+    std::atomic<bool> stopping { false };
+    std::atomic<bool> outOfTime { false };
+    JobFunction jobFunction { nullptr };
+    void* jobContext { nullptr };
+    std::uint32_t batch { 0 };
+    Clock::time_point deadline {};
+    double callbackPeriod { 0.0 };
+    std::vector<std::thread> workers;
+};
+} // namespace secretsynth::dsp::voice
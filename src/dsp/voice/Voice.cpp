@@ -2,15 +2,25 @@
 
 #include <algorithm>
 #include <cmath>
+#include <functional>
 #include <limits>
 
 namespace secretsynth::dsp::voice
 {
 namespace
 {
-constexpr float a4Frequency = 440.0f;
-constexpr int a4MidiNote = 69;
-constexpr float semitonesPerOctave = 12.0f;
+constexpr float oscillatorLevel = 0.1f;
+constexpr float cutoffModulationRangeHz = 8000.0f;
+
+constexpr std::size_t sourceIndex (mod::Source source) noexcept
+{
+    return static_cast<std::size_t> (source);
+}
+
+constexpr std::size_t destinationIndex (mod::Destination destination) noexcept
+{
+    return static_cast<std::size_t> (destination);
+}
 } // namespace
 
 void Voice::reset() noexcept
@@ -20,9 +30,31 @@ void Voice::reset() noexcept
     keyHeld = false;
     currentPitchHz = 0.0f;
     targetPitchHz = 0.0f;
-    glideProgress = 1.0f;
-    glideDurationSamples = 0.0f;
+    glideSamplesRemaining = 0;
+    glideIncrement = 0.0f;
+    glideRatio = 1.0f;
     releaseSamplesRemaining = 0;
+    fadeGain = 1.0f;
+    fadeStep = 0.0f;
+
+    laneCount = 1;
+    laneDetuneCents.fill (0.0f);
+    lanePans.fill (0.0f);
+    laneRatios.fill (1.0f);
+    lanePhases.fill (0.0f);
+    laneGainsLeft.fill (0.0f);
+    laneGainsRight.fill (0.0f);
+
+    oscillator.reset();
+    for (auto& laneFilter : laneFilters)
+        laneFilter.reset();
+
+    ampEnv.reset();
+    modEnv.reset();
+    lastModulation = {};
+    controlAmp = 0.0f;
+    outputLevel = 0.0f;
+    appliedParameterRevision = 0;
 }
 
 void Voice::prepare (double newSampleRate, int newBlockSize) noexcept
@@ -32,34 +64,100 @@ void Voice::prepare (double newSampleRate, int newBlockSize) noexcept
 
     if (newBlockSize > 0)
         blockSize = newBlockSize;
+
+    oscillator.prepare (sampleRate);
+    for (auto& laneFilter : laneFilters)
+    {
+        laneFilter.prepare (sampleRate);
+        laneFilter.setMode (filter::MultiModeFilter::Mode::lowPass);
+        laneFilter.setKeyTrackingReferenceHz (tuning::referenceFrequencyHz);
+    }
+
+    ampEnv.setSampleRate (sampleRate);
+    modEnv.setSampleRate (sampleRate);
+    appliedParameterRevision = 0;
+    outputLevelDecay = static_cast<float> (std::exp (-1.0 / (outputLevelDecaySeconds * sampleRate)));
 }
 
 void Voice::startNote (const NoteEvent& event, float startPitchHz, float glideTimeSeconds, GlideCurve curve, bool restartPhase) noexcept
 {
-    (void) restartPhase;
+    // Legato retargets (restartPhase == false on a sounding voice) keep the envelopes running.
+    const auto retrigger = restartPhase || state != State::active;
+
+    // A hard restart starts from silence, like the attack it triggers: the gain ramp rises from 0
+    // and the filters forget the previous note, whose tail a ghost voice is already fading out.
+    if (restartPhase)
+    {
+        lanePhases.fill (0.0f);
+        for (auto& laneFilter : laneFilters)
+            laneFilter.reset();
+
+        controlAmp = 0.0f;
+    }
+
+    if (retrigger)
+    {
+        ampEnv.noteOn();
+        modEnv.noteOn();
+    }
 
     note = event;
     state = State::active;
     keyHeld = true;
-    targetPitchHz = midiNoteToFrequency (event.midiNote) * std::pow (2.0f, event.detuneCents / 1200.0f);
+    targetPitchHz = event.frequencyHz > 0.0f ? event.frequencyHz : tuning::midiNoteToFrequency (event.midiNote);
+
+    laneCount = std::clamp (event.unisonLanes, 1, maxUnisonLanes);
+    if (laneCount == 1)
+    {
+        const mix::StereoMixBus::PanGains centre;
+        laneDetuneCents[0] = 0.0f;
+        lanePans[0] = 0.0f;
+        laneRatios[0] = 1.0f;
+        laneGainsLeft[0] = centre.left;
+        laneGainsRight[0] = centre.right;
+    }
+    else
+    {
+        const auto center = static_cast<float> (laneCount - 1) * 0.5f;
+        for (int lane = 0; lane < laneCount; ++lane)
+        {
+            const auto index = static_cast<std::size_t> (lane);
+            const auto offset = static_cast<float> (lane) - center;
+
+            laneDetuneCents[index] = offset * event.unisonDetuneCents;
+            lanePans[index] = (offset / center) * event.unisonSpread;
+            laneRatios[index] = tuning::centsToRatio (laneDetuneCents[index]);
 
-    const auto glideSamples = static_cast<float> (std::max (0.0f, glideTimeSeconds) * sampleRate);
+            const auto gains = mix::StereoMixBus::constantPowerPan (lanePans[index]);
+            laneGainsLeft[index] = gains.left;
+            laneGainsRight[index] = gains.right;
+        }
+    }
+
+    const auto glideSamples = static_cast<int> (std::round (std::max (0.0f, glideTimeSeconds) * sampleRate));
     glideCurve = curve;
+    glideIncrement = 0.0f;
+    glideRatio = 1.0f;
 
-    if (glideSamples <= 1.0f || startPitchHz <= std::numeric_limits<float>::epsilon())
+    if (glideSamples <= 1 || startPitchHz <= std::numeric_limits<float>::epsilon())
     {
         currentPitchHz = targetPitchHz;
-        glideProgress = 1.0f;
-        glideDurationSamples = 0.0f;
+        glideSamplesRemaining = 0;
     }
     else
     {
         currentPitchHz = startPitchHz;
-        glideProgress = 0.0f;
-        glideDurationSamples = glideSamples;
+        glideSamplesRemaining = glideSamples;
+
+        if (curve == GlideCurve::linear)
+            glideIncrement = (targetPitchHz - startPitchHz) / static_cast<float> (glideSamples);
+        else
+            glideRatio = static_cast<float> (std::exp (std::log (static_cast<double> (targetPitchHz) / startPitchHz) / glideSamples));
     }
 
     releaseSamplesRemaining = 0;
+    fadeGain = 1.0f;
+    fadeStep = 0.0f;
 }
 
 void Voice::startRelease (float releaseTimeSeconds) noexcept
@@ -69,6 +167,9 @@ void Voice::startRelease (float releaseTimeSeconds) noexcept
     if (state == State::idle)
         return;
 
+    ampEnv.noteOff();
+    modEnv.noteOff();
+
     const auto clamped = std::max (0.0f, releaseTimeSeconds);
     releaseSamplesRemaining = static_cast<int> (std::round (clamped * static_cast<float> (sampleRate)));
 
@@ -81,6 +182,26 @@ void Voice::startRelease (float releaseTimeSeconds) noexcept
     state = State::releasing;
 }
 
+void Voice::startFadeOut (float fadeTimeSeconds) noexcept
+{
+    keyHeld = false;
+
+    if (state == State::idle)
+        return;
+
+    if (state == State::active)
+    {
+        ampEnv.noteOff();
+        modEnv.noteOff();
+        releaseSamplesRemaining = std::numeric_limits<int>::max();
+    }
+
+    const auto fadeSamples = std::max (1, static_cast<int> (std::round (std::max (0.0f, fadeTimeSeconds) * static_cast<float> (sampleRate))));
+    fadeStep = std::max (fadeStep, fadeGain / static_cast<float> (fadeSamples));
+    releaseSamplesRemaining = std::min (releaseSamplesRemaining, fadeSamples);
+    state = State::releasing;
+}
+
 void Voice::forceIdle() noexcept
 {
     reset();
@@ -91,28 +212,56 @@ void Voice::advance (int numSamples) noexcept
     if (state == State::idle)
         return;
 
-    if (glideProgress < 1.0f && glideDurationSamples > 0.0f)
-    {
-        glideProgress = std::min (1.0f, glideProgress + static_cast<float> (numSamples) / glideDurationSamples);
+    advanceGlide (numSamples);
+    advanceRelease (numSamples);
+}
 
-        if (glideCurve == GlideCurve::linear)
-        {
-            currentPitchHz += (targetPitchHz - currentPitchHz) * glideProgress;
-        }
-        else
+void Voice::renderPitch (float* output, int numSamples) noexcept
+{
+    auto sample = 0;
+    const auto glideSamples = std::min (numSamples, glideSamplesRemaining);
+
+    if (glideCurve == GlideCurve::linear)
+    {
+        for (; sample < glideSamples; ++sample)
         {
-            const auto ratio = std::max (0.000001f, targetPitchHz / std::max (0.000001f, currentPitchHz));
-            currentPitchHz *= std::pow (ratio, glideProgress);
+            output[sample] = currentPitchHz;
+            currentPitchHz += glideIncrement;
         }
-
-        if (glideProgress >= 1.0f)
-            currentPitchHz = targetPitchHz;
     }
     else
     {
+        for (; sample < glideSamples; ++sample)
+        {
+            output[sample] = currentPitchHz;
+            currentPitchHz *= glideRatio;
+        }
+    }
+
+    glideSamplesRemaining -= glideSamples;
+    if (glideSamplesRemaining <= 0)
         currentPitchHz = targetPitchHz;
+
+    std::fill (output + sample, output + numSamples, currentPitchHz);
+}
+
+void Voice::advanceGlide (int numSamples) noexcept
+{
+    std::array<float, controlBlockSize> discard {};
+
+    while (numSamples > 0 && glideSamplesRemaining > 0)
+    {
+        const auto chunk = std::min (numSamples, controlBlockSize);
+        renderPitch (discard.data(), chunk);
+        numSamples -= chunk;
     }
 
+    if (glideSamplesRemaining <= 0)
+        currentPitchHz = targetPitchHz;
+}
+
+void Voice::advanceRelease (int numSamples) noexcept
+{
     if (state == State::releasing)
     {
         releaseSamplesRemaining -= numSamples;
@@ -121,8 +270,116 @@ void Voice::advance (int numSamples) noexcept
     }
 }
 
-float Voice::midiNoteToFrequency (int midiNote) noexcept
+void Voice::render (float* left, float* right, int numSamples, const RenderContext& context) noexcept
 {
-    return a4Frequency * std::pow (2.0f, (static_cast<float> (midiNote) - a4MidiNote) / semitonesPerOctave);
+    if (state == State::idle || numSamples <= 0 || context.parameters == nullptr)
+        return;
+
+    const auto& parameters = *context.parameters;
+    auto& coefficientFilter = laneFilters.front();
+
+    if (parameters.revision == 0 || parameters.revision != appliedParameterRevision)
+    {
+        oscillator.setQualityMode (parameters.oscillatorQuality);
+        oscillator.setPdShape (parameters.pdShape);
+        oscillator.setTune (parameters.tuneSemitones);
+        oscillator.setFine (parameters.fineCents);
+        oscillator.setMix (parameters.oscillatorMix);
+        coefficientFilter.setResonance (parameters.filterResonance);
+        coefficientFilter.setKeyTracking (parameters.filterKeyTracking);
+        ampEnv.setParameters (parameters.ampEnvelope);
+        modEnv.setParameters (parameters.modEnvelope);
+        appliedParameterRevision = parameters.revision;
+    }
+
+    std::array<float, static_cast<std::size_t> (mod::Source::count)> sources {};
+    sources[sourceIndex (mod::Source::velocity)] = note.velocity;
+    sources[sourceIndex (mod::Source::keyTrack)] = static_cast<float> (note.midiNote) / 127.0f;
+
+    std::array<float, controlBlockSize> pitch {};
+    std::array<float, controlBlockSize> frequency {};
+    std::array<float, maxUnisonLanes * controlBlockSize> laneSamples {};
+    std::array<float, controlBlockSize> mixLeft {};
+    std::array<float, controlBlockSize> mixRight {};
+    DestinationValues destinations {};
+
+    for (int blockStart = 0; blockStart < numSamples; blockStart += controlBlockSize)
+    {
+        const auto block = std::min (controlBlockSize, numSamples - blockStart);
+        const auto lastSample = blockStart + block - 1;
+        renderPitch (pitch.data(), block);
+
+        // Control rate: envelopes advance over the block and everything else is sampled at its end.
+        sources[sourceIndex (mod::Source::ampEnv)] = ampEnv.advance (block);
+        sources[sourceIndex (mod::Source::modEnv)] = modEnv.advance (block);
+        sources[sourceIndex (mod::Source::lfo1)] = context.lfo1 != nullptr ? context.lfo1[lastSample] : 0.0f;
+        sources[sourceIndex (mod::Source::lfo2)] = context.lfo2 != nullptr ? context.lfo2[lastSample] : 0.0f;
+
+        if (context.modulation != nullptr)
+            destinations = context.modulation->evaluate (sources);
+
+        // A pitch depth of 1 is one octave.
+        const auto pitchMod = destinations[destinationIndex (mod::Destination::pitch)];
+        const auto pitchRatio = std::equal_to<> {} (pitchMod, 0.0f) ? 1.0f : tuning::octavesToRatio (pitchMod);
+        for (int i = 0; i < block; ++i)
+            frequency[static_cast<std::size_t> (i)] = pitch[static_cast<std::size_t> (i)] * pitchRatio;
+
+        const auto pdAmount = context.pdAmountRamp != nullptr ? context.pdAmountRamp[lastSample] : parameters.pdAmount;
+        const auto cutoffHz = context.filterCutoffRamp != nullptr ? context.filterCutoffRamp[lastSample] : parameters.filterCutoffHz;
+        oscillator.setPdAmount (pdAmount + destinations[destinationIndex (mod::Destination::pdAmount)]);
+        coefficientFilter.setCutoffHz (std::clamp (cutoffHz + cutoffModulationRangeHz * destinations[destinationIndex (mod::Destination::filterCutoff)],
+                                                   20.0f,
+                                                   20000.0f));
+        const auto coefficients = coefficientFilter.computeCoefficients (pitch[static_cast<std::size_t> (block - 1)]);
+
+        // Audio rate: each lane renders and filters the whole block before the lanes are mixed.
+        oscillator.renderLanes (frequency.data(), laneRatios.data(), lanePhases.data(), laneSamples.data(), controlBlockSize, laneCount, block);
+
+        std::fill_n (mixLeft.begin(), block, 0.0f);
+        std::fill_n (mixRight.begin(), block, 0.0f);
+        for (int lane = 0; lane < laneCount; ++lane)
+        {
+            const auto index = static_cast<std::size_t> (lane);
+            auto* samples = laneSamples.data() + index * controlBlockSize;
+            for (int i = 0; i < block; ++i)
+                samples[i] *= oscillatorLevel;
+
+            laneFilters[index].processBlock (samples, block, coefficients);
+
+            for (int i = 0; i < block; ++i)
+            {
+                mixLeft[static_cast<std::size_t> (i)] += samples[i] * laneGainsLeft[index];
+                mixRight[static_cast<std::size_t> (i)] += samples[i] * laneGainsRight[index];
+            }
+        }
+
+        const auto targetAmp = std::clamp (destinations[destinationIndex (mod::Destination::amp)], 0.0f, 1.0f);
+        const auto ampStep = (targetAmp - controlAmp) / static_cast<float> (block);
+        for (int i = 0; i < block; ++i)
+        {
+            const auto sample = blockStart + i;
+            const auto gain = (controlAmp + ampStep * static_cast<float> (i + 1)) * fadeGain;
+            const auto valueLeft = mixLeft[static_cast<std::size_t> (i)] * gain;
+            const auto valueRight = mixRight[static_cast<std::size_t> (i)] * gain;
+            left[sample] += valueLeft;
+            right[sample] += valueRight;
+            fadeGain = std::max (0.0f, fadeGain - fadeStep);
+
+            // Peak follower over the voice output; it decays slowly enough to ride over zero crossings.
+            outputLevel = std::max (std::max (std::abs (valueLeft), std::abs (valueRight)), outputLevel * outputLevelDecay);
+        }
+
+        controlAmp = targetAmp;
+    }
+
+    lastModulation = destinations;
+
+    if (state == State::releasing && outputLevel < silenceThreshold)
+    {
+        forceIdle();
+        return;
+    }
+
+    advanceRelease (numSamples);
 }
 } // namespace secretsynth::dsp::voice
@@ -1,5 +1,13 @@
 #pragma once
 
+#include "../filter/MultiModeFilter.h"
+#include "../mix/StereoMixBus.h"
+#include "../mod/Modulation.h"
+#include "../osc/PhaseWarpOscillator.h"
+#include "../tuning/PitchTable.h"
+
+#include <array>
+#include <cstddef>
 #include <cstdint>
 
 namespace secretsynth::dsp::voice
@@ -10,7 +18,7 @@ enum class GlideCurve
     exponential
 };
 
-class Voice
+class alignas (64) Voice
 {
 public:
     enum class State
@@ -20,16 +28,64 @@ public:
         releasing
     };
 
+    // A note renders unisonLanes detuned copies as lanes of this one voice. Lanes are spread
+    // symmetrically: detune steps of unisonDetuneCents and pans scaled by unisonSpread. A frequencyHz
+    // of 0 plays midiNote in twelve-tone equal temperament.
     struct NoteEvent
     {
         int midiNote { -1 };
         float velocity { 0.0f };
         std::uint64_t eventIndex { 0 };
-        int unisonIndex { 0 };
-        float detuneCents { 0.0f };
-        float spreadPan { 0.0f };
+        int unisonLanes { 1 };
+        float unisonDetuneCents { 0.0f };
+        float unisonSpread { 0.0f };
+        float frequencyHz { 0.0f };
+    };
+
+    static constexpr int maxUnisonLanes = 8;
+
+    // Envelopes, the modulation matrix, pd amount and filter coefficients are updated once per
+    // control block; the oscillator and filters then run over the whole block. Owners that render
+    // in blocks aligned to this size get one control update per block.
+    static constexpr int controlBlockSize = 32;
+
+    // Patch settings shared by every voice; refreshed by the owner once per block. An owner that
+    // bumps revision on every change lets voices skip re-applying unchanged settings; revision 0
+    // applies them on every render.
+    struct RenderParameters
+    {
+        std::uint32_t revision { 0 };
+        float pdAmount { 0.6f };
+        float pdShape { 0.5f };
+        float tuneSemitones { 0.0f };
+        float fineCents { 0.0f };
+        float oscillatorMix { 1.0f };
+        osc::PhaseWarpOscillator::QualityMode oscillatorQuality { osc::PhaseWarpOscillator::QualityMode::high };
+        float filterCutoffHz { 1800.0f };
+        float filterResonance { 0.6f };
+        float filterKeyTracking { 0.5f };
+        mod::AdsrEnvelope::Parameters ampEnvelope { 0.005f, 0.12f, 0.9f, 0.3f };
+        mod::AdsrEnvelope::Parameters modEnvelope { 0.02f, 0.3f, 0.0f, 0.4f };
+    };
+
+    // Per-render inputs. LFO buffers hold unipolar values and must cover numSamples. The pd amount
+    // and cutoff ramps are optional smoothed per-sample values; nullptr uses the RenderParameters value.
+    // Modulation runs at control rate, so these are read at the last sample of each control block:
+    // ramps are quantised to controlBlockSize steps, and a ramp shorter than one control block
+    // lands on its end value in a single step. The processor's 20 ms parameter ramps span many
+    // control blocks.
+    struct RenderContext
+    {
+        const RenderParameters* parameters { nullptr };
+        const mod::ModulationMatrix* modulation { nullptr };
+        const float* lfo1 { nullptr };
+        const float* lfo2 { nullptr };
+        const float* pdAmountRamp { nullptr };
+        const float* filterCutoffRamp { nullptr };
     };
 
+    using DestinationValues = std::array<float, static_cast<std::size_t> (mod::Destination::count)>;
+
     Voice() = default;
 
     void reset() noexcept;
@@ -37,22 +93,45 @@ public:
 
     void startNote (const NoteEvent& event, float startPitchHz, float glideTimeSeconds, GlideCurve curve, bool restartPhase) noexcept;
     void startRelease (float releaseTimeSeconds) noexcept;
+
+    // Ramps the voice to silence over fadeTimeSeconds regardless of its envelopes, then idles it.
+    // Used when voices have to be shed quickly without clicking.
+    void startFadeOut (float fadeTimeSeconds) noexcept;
     void forceIdle() noexcept;
     void advance (int numSamples) noexcept;
 
+    // Writes the per-sample glide trajectory and advances it. Linear glides use an additive
+    // recurrence in Hz, exponential glides a multiplicative one (linear in log-frequency);
+    // both coefficients are fixed in startNote, so this never calls a transcendental.
+    void renderPitch (float* output, int numSamples) noexcept;
+
+    // Adds numSamples of this voice into the left/right buffers, each lane at its constant-power
+    // pan, then advances glide/release state. Amplitude is interpolated across each control block.
+    void render (float* left, float* right, int numSamples, const RenderContext& context) noexcept;
+
     [[nodiscard]] int getMidiNote() const noexcept { return note.midiNote; }
     [[nodiscard]] float getVelocity() const noexcept { return note.velocity; }
     [[nodiscard]] State getState() const noexcept { return state; }
     [[nodiscard]] bool isKeyHeld() const noexcept { return keyHeld; }
+    [[nodiscard]] bool isFadingOut() const noexcept { return fadeStep > 0.0f; }
     [[nodiscard]] std::uint64_t getStartEventIndex() const noexcept { return note.eventIndex; }
     [[nodiscard]] float getCurrentPitchHz() const noexcept { return currentPitchHz; }
     [[nodiscard]] float getTargetPitchHz() const noexcept { return targetPitchHz; }
-    [[nodiscard]] int getUnisonIndex() const noexcept { return note.unisonIndex; }
-    [[nodiscard]] float getDetuneCents() const noexcept { return note.detuneCents; }
-    [[nodiscard]] float getSpreadPan() const noexcept { return note.spreadPan; }
+    [[nodiscard]] int getUnisonLaneCount() const noexcept { return laneCount; }
+    [[nodiscard]] float getLaneDetuneCents (int lane) const noexcept { return laneDetuneCents[static_cast<std::size_t> (lane)]; }
+    [[nodiscard]] float getLanePan (int lane) const noexcept { return lanePans[static_cast<std::size_t> (lane)]; }
+    [[nodiscard]] const DestinationValues& getLastModulation() const noexcept { return lastModulation; }
+    [[nodiscard]] float getOutputLevel() const noexcept { return outputLevel; }
+
+    // Releasing voices whose output level falls below this (-96 dBFS) go idle without
+    // waiting for the release countdown.
+    static constexpr float silenceThreshold = 1.5849e-5f;
 
 private:
-    static float midiNoteToFrequency (int midiNote) noexcept;
+    static constexpr float outputLevelDecaySeconds = 0.05f;
+
+    void advanceGlide (int numSamples) noexcept;
+    void advanceRelease (int numSamples) noexcept;
 
     NoteEvent note {};
     State state { State::idle };
@@ -62,10 +141,33 @@ private:
 
     float currentPitchHz { 0.0f };
     float targetPitchHz { 0.0f };
-    float glideProgress { 1.0f };
-    float glideDurationSamples { 0.0f };
+    int glideSamplesRemaining { 0 };
+    float glideIncrement { 0.0f };
+    float glideRatio { 1.0f };
     GlideCurve glideCurve { GlideCurve::linear };
 
     int releaseSamplesRemaining { 0 };
+    float fadeGain { 1.0f };
+    float fadeStep { 0.0f };
+
+    // Lanes share the oscillator's shape settings, the envelopes, the modulation and the filter
+    // coefficients; only phase, detune ratio, filter state and pan are per lane.
+    int laneCount { 1 };
+    std::array<float, maxUnisonLanes> laneDetuneCents {};
+    std::array<float, maxUnisonLanes> lanePans {};
+    std::array<float, maxUnisonLanes> laneRatios {};
+    std::array<float, maxUnisonLanes> lanePhases {};
+    std::array<float, maxUnisonLanes> laneGainsLeft {};
+    std::array<float, maxUnisonLanes> laneGainsRight {};
+
+    osc::PhaseWarpOscillator oscillator;
+    std::array<filter::MultiModeFilter, maxUnisonLanes> laneFilters;
+    mod::AdsrEnvelope ampEnv;
+    mod::AdsrEnvelope modEnv;
+    DestinationValues lastModulation {};
+    float controlAmp { 0.0f }; // amp destination at the end of the last control block
+    float outputLevel { 0.0f };
+    float outputLevelDecay { 0.0f };
+    std::uint32_t appliedParameterRevision { 0 };
 };
 } // namespace secretsynth::dsp::voice
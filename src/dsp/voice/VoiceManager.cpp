@@ -1,30 +1,31 @@
 #include "VoiceManager.h"
 
+#include "../trace/Trace.h"
+
 #include <algorithm>
+#include <chrono>
 #include <cmath>
-#include <limits>
-#include <tuple>
 
 namespace secretsynth::dsp::voice
 {
 VoiceManager::VoiceManager()
 {
-    ensureVoiceCount();
+    noteHeads.fill (noVoice);
 }
 
 VoiceManager::VoiceManager (Config newConfig)
     : config (newConfig)
 {
-    ensureVoiceCount();
+    noteHeads.fill (noVoice);
 }
 
 void VoiceManager::setConfig (const Config& newConfig)
 {
     config = newConfig;
-    ensureVoiceCount();
+    applyActiveCapacity();
 }
 
-void VoiceManager::prepare (double newSampleRate, int newBlockSize)
+void VoiceManager::prepare (double newSampleRate, int newBlockSize, std::size_t poolSize)
 {
     if (newSampleRate > 0.0)
         sampleRate = newSampleRate;
@@ -32,20 +33,53 @@ void VoiceManager::prepare (double newSampleRate, int newBlockSize)
     if (newBlockSize > 0)
         blockSize = newBlockSize;
 
+    poolSize = std::max<std::size_t> (1, poolSize);
+    if (voices.size() != poolSize)
+    {
+        voices.assign (poolSize, Voice {});
+        links.assign (poolSize, {});
+        activeCapacity = 0;
+        rebuildVoiceLists();
+    }
+
     for (auto& voice : voices)
         voice.prepare (sampleRate, blockSize);
+
+    for (auto& ghost : ghostVoices)
+        ghost.prepare (sampleRate, blockSize);
+
+    const auto maxJobs = poolSize + ghostVoiceCount;
+    if (renderJobs.size() != maxJobs)
+        renderJobs.assign (maxJobs, nullptr);
+
+    const auto bufferSize = 2 * maxJobs * static_cast<std::size_t> (std::max (0, blockSize));
+    if (jobBuffers.size() != bufferSize)
+        jobBuffers.assign (bufferSize, 0.0f);
+
+    applyActiveCapacity();
 }
 
 void VoiceManager::reset()
 {
-    heldNotes.clear();
+    clearHeldNotes();
     eventCounter = 1;
     for (auto& voice : voices)
         voice.reset();
+
+    for (auto& ghost : ghostVoices)
+        ghost.reset();
+
+    nextGhost = 0;
+    rebuildVoiceLists();
 }
 
 void VoiceManager::noteOn (int midiNote, float velocity)
 {
+    SECRETSYNTH_TRACE_SCOPE ("VoiceManager::noteOn");
+
+    if (midiNote < 0 || midiNote >= midiNoteCount || noteFrequency (midiNote) <= 0.0f)
+        return;
+
     pushHeldNote (midiNote, velocity);
 
     if (isMonophonicMode())
@@ -58,33 +92,32 @@ void VoiceManager::noteOn (int midiNote, float velocity)
             ? monoVoice->getCurrentPitchHz()
             : 0.0f;
 
-        const Voice::NoteEvent event { midiNote, velocity, eventCounter++, 0, 0.0f, 0.0f };
+        const Voice::NoteEvent event { .midiNote = midiNote, .velocity = velocity, .eventIndex = eventCounter++, .frequencyHz = noteFrequency (midiNote) };
         monoVoice->startNote (event, startPitch, config.glideTimeSeconds, config.glideCurve, true);
+        touchVoice (0);
         return;
     }
 
-    const auto unisonCount = requiredUnisonCount();
-    for (int unisonIndex = 0; unisonIndex < unisonCount; ++unisonIndex)
+    // Unison copies are lanes of a single voice, so every mode allocates one voice per note.
+    auto* target = findVoiceForNote (midiNote);
+    if (target == nullptr)
     {
-        auto* target = findVoiceForNote (midiNote, unisonIndex);
-        if (target == nullptr)
-            target = findStealVoice();
-
+        target = findStealVoice();
         if (target == nullptr)
-            continue;
-
-        const auto center = static_cast<float> (unisonCount - 1) * 0.5f;
-        const auto offset = static_cast<float> (unisonIndex) - center;
-        const auto detune = (unisonCount > 1) ? offset * config.unisonDetuneCents : 0.0f;
-        const auto spreadNorm = (unisonCount > 1) ? offset / center : 0.0f;
-        const auto spreadPan = spreadNorm * config.unisonSpread;
+            return;
 
-        startNoteOnVoice (*target, midiNote, velocity, eventCounter++, unisonIndex, detune, spreadPan, true);
+        handOffToGhost (*target);
     }
+
+    startNoteOnVoice (*target, midiNote, velocity, eventCounter++, true);
+    touchVoice (indexOf (*target));
 }
 
 void VoiceManager::noteOff (int midiNote)
 {
+    if (midiNote < 0 || midiNote >= midiNoteCount)
+        return;
+
     removeHeldNote (midiNote);
 
     if (isMonophonicMode())
@@ -96,12 +129,16 @@ void VoiceManager::noteOff (int midiNote)
         const auto next = latestHeldNote();
         if (config.mode == Mode::legato && next.midiNote >= 0)
         {
-            const Voice::NoteEvent event { next.midiNote, next.velocity, eventCounter++, 0, 0.0f, 0.0f };
+            const Voice::NoteEvent event {
+                .midiNote = next.midiNote, .velocity = next.velocity, .eventIndex = eventCounter++, .frequencyHz = noteFrequency (next.midiNote)
+            };
             monoVoice->startNote (event, monoVoice->getCurrentPitchHz(), config.glideTimeSeconds, config.glideCurve, false);
+            touchVoice (0);
             return;
         }
 
         monoVoice->startRelease (config.releaseTimeSeconds);
+        touchVoice (0);
         return;
     }
 
@@ -110,15 +147,143 @@ void VoiceManager::noteOff (int midiNote)
 
 void VoiceManager::allNotesOff()
 {
-    heldNotes.clear();
-    for (auto& voice : voices)
-        voice.startRelease (config.releaseTimeSeconds);
+    clearHeldNotes();
+    for (std::size_t index = 0; index < voices.size(); ++index)
+    {
+        if (voices[index].getState() == Voice::State::idle)
+            continue;
+
+        voices[index].startRelease (config.releaseTimeSeconds);
+        touchVoice (index);
+    }
+}
+
+void VoiceManager::setGovernorConfig (const GovernorConfig& newConfig) noexcept
+{
+    governor = newConfig;
+    voiceCap = activeCapacity;
+    headroomBlocks = 0;
+    overloadedBlocks = 0;
+}
+
+void VoiceManager::reportRenderTime (double renderSeconds, int numSamples) noexcept
+{
+    if (governor.budgetFraction <= 0.0f || numSamples <= 0 || isMonophonicMode())
+        return;
+
+    const auto load = renderSeconds * sampleRate / static_cast<double> (numSamples);
+    const auto budget = static_cast<double> (governor.budgetFraction);
+    const auto minimumCap = std::min (activeCapacity, std::max<std::size_t> (1, governor.minimumVoices));
+
+    if (load > budget)
+    {
+        headroomBlocks = 0;
+        sustainedLoad = overloadedBlocks == 0 ? load : std::min (sustainedLoad, load);
+        if (++overloadedBlocks < std::max (2, governor.overloadBlocks))
+            return;
+
+        // Render cost scales roughly with voice count, so shrink the cap by the overshoot the whole
+        // run sustained rather than by its worst block.
+        const auto sounding = std::min (voiceCap, countUnfadedVoices());
+        const auto scaled = static_cast<std::size_t> (static_cast<double> (sounding) * budget / sustainedLoad);
+        voiceCap = std::max (minimumCap, std::min (scaled, sounding > 0 ? sounding - 1 : 0));
+        overloadedBlocks = 0;
+        shedVoicesOverCap();
+        return;
+    }
+
+    overloadedBlocks = 0;
+
+    if (load < budget * static_cast<double> (governor.recoveryFraction) && voiceCap < activeCapacity)
+    {
+        if (++headroomBlocks >= std::max (1, governor.recoveryBlocks))
+        {
+            ++voiceCap;
+            headroomBlocks = 0;
+        }
+        return;
+    }
+
+    headroomBlocks = 0;
 }
 
 void VoiceManager::advance (int numSamples)
 {
-    for (auto& voice : voices)
-        voice.advance (numSamples);
+    for (std::size_t index = 0; index < voices.size(); ++index)
+    {
+        voices[index].advance (numSamples);
+        syncVoiceList (index);
+    }
+
+    for (auto& ghost : ghostVoices)
+        ghost.advance (numSamples);
+}
+
+void VoiceManager::render (float* left, float* right, int numSamples, const Voice::RenderContext& context) noexcept
+{
+    const RenderSlice slice { numSamples, context };
+    render (left, right, std::span (&slice, 1));
+}
+
+void VoiceManager::render (float* left, float* right, std::span<const RenderSlice> slices) noexcept
+{
+    auto numSamples = 0;
+    for (const auto& slice : slices)
+        numSamples += slice.numSamples;
+
+    if (shouldRenderInParallel (numSamples))
+    {
+        renderParallel (left, right, slices, numSamples);
+        return;
+    }
+
+    for (const auto& slice : slices)
+    {
+        renderList (ListId::active, left, right, slice.numSamples, slice.context);
+        renderList (ListId::releasing, left, right, slice.numSamples, slice.context);
+        renderList (ListId::retiring, left, right, slice.numSamples, slice.context);
+
+        for (auto& ghost : ghostVoices)
+            ghost.render (left, right, slice.numSamples, slice.context);
+
+        left += slice.numSamples;
+        right += slice.numSamples;
+    }
+}
+
+int VoiceManager::getActiveVoiceCount() const noexcept
+{
+    return static_cast<int> (activeVoices.size + releasingVoices.size + retiringVoices.size);
+}
+
+int VoiceManager::getGhostVoiceCount() const noexcept
+{
+    return static_cast<int> (std::count_if (ghostVoices.begin(), ghostVoices.end(), [] (const Voice& ghost) {
+        return ghost.getState() != Voice::State::idle;
+    }));
+}
+
+bool VoiceManager::isIdle() const noexcept
+{
+    return getActiveVoiceCount() == 0 && getGhostVoiceCount() == 0;
+}
+
+const Voice* VoiceManager::getNewestVoice() const noexcept
+{
+    if (activeVoices.tail != noVoice)
+        return &voices[activeVoices.tail];
+
+    const Voice* newest = nullptr;
+    for (const auto* list : { &releasingVoices, &retiringVoices })
+    {
+        for (auto index = list->head; index != noVoice; index = links[index].next)
+        {
+            if (newest == nullptr || voices[index].getStartEventIndex() > newest->getStartEventIndex())
+                newest = &voices[index];
+        }
+    }
+
+    return newest;
 }
 
 std::size_t VoiceManager::targetVoiceCount() const
@@ -126,7 +291,8 @@ std::size_t VoiceManager::targetVoiceCount() const
     if (isMonophonicMode())
         return 1;
 
-    return std::max<std::size_t> (1, config.maxVoices);
+    // maxVoices counts rendered unison copies, so a stack of N lanes takes N of them.
+    return std::max<std::size_t> (1, config.maxVoices / static_cast<std::size_t> (unisonLaneCount()));
 }
 
 bool VoiceManager::isMonophonicMode() const
@@ -134,97 +300,479 @@ bool VoiceManager::isMonophonicMode() const
     return config.mode == Mode::mono || config.mode == Mode::legato;
 }
 
-int VoiceManager::requiredUnisonCount() const
+int VoiceManager::unisonLaneCount() const
 {
     if (config.mode != Mode::unison)
         return 1;
 
-    return std::max (1, config.unisonVoices);
+    return std::clamp (config.unisonVoices, 1, Voice::maxUnisonLanes);
 }
 
-void VoiceManager::ensureVoiceCount()
+float VoiceManager::noteFrequency (int midiNote) const noexcept
 {
-    voices.resize (targetVoiceCount());
-    for (auto& voice : voices)
-        voice.prepare (sampleRate, blockSize);
+    return tuningTable != nullptr ? tuningTable->getFrequency (midiNote) : tuning::midiNoteToFrequency (midiNote);
+}
+
+void VoiceManager::applyActiveCapacity()
+{
+    activeCapacity = std::min (targetVoiceCount(), voices.size());
+    voiceCap = activeCapacity;
+    headroomBlocks = 0;
+
+    for (std::size_t index = 0; index < voices.size(); ++index)
+    {
+        auto& voice = voices[index];
+
+        // Voices pushed out of the window fade out through their normal release.
+        if (index >= activeCapacity && voice.getState() == Voice::State::active)
+            voice.startRelease (config.releaseTimeSeconds);
+
+        syncVoiceList (index);
+    }
+}
+
+void VoiceManager::rebuildVoiceLists() noexcept
+{
+    for (auto& link : links)
+        link = {};
+
+    freeVoices = {};
+    releasingVoices = {};
+    activeVoices = {};
+    retiringVoices = {};
+    noteHeads.fill (noVoice);
+
+    for (std::size_t index = 0; index < voices.size(); ++index)
+    {
+        insertVoiceByAge (listForVoice (index), index);
+        indexVoiceNote (index);
+    }
+}
+
+VoiceManager::VoiceList& VoiceManager::getList (ListId id) noexcept
+{
+    switch (id)
+    {
+        case ListId::releasing: return releasingVoices;
+        case ListId::active: return activeVoices;
+        case ListId::retiring: return retiringVoices;
+        case ListId::free:
+        case ListId::none:
+        default: return freeVoices;
+    }
+}
+
+VoiceManager::ListId VoiceManager::listForVoice (std::size_t index) const noexcept
+{
+    const auto state = voices[index].getState();
+
+    if (index >= activeCapacity)
+        return state == Voice::State::idle ? ListId::none : ListId::retiring;
+
+    switch (state)
+    {
+        case Voice::State::active: return ListId::active;
+        case Voice::State::releasing: return ListId::releasing;
+        case Voice::State::idle:
+        default: return ListId::free;
+    }
+}
+
+void VoiceManager::insertVoiceByAge (ListId id, std::size_t index) noexcept
+{
+    if (id == ListId::none)
+        return;
+
+    // Only used when rebuilding, where voices can arrive out of start order.
+    auto& list = getList (id);
+    auto after = list.tail;
+    const auto age = voices[index].getStartEventIndex();
+    while (after != noVoice && voices[after].getStartEventIndex() > age)
+        after = links[after].previous;
+
+    auto& link = links[index];
+    link.list = id;
+    link.previous = after;
+    link.next = after == noVoice ? list.head : links[after].next;
+
+    if (link.next != noVoice)
+        links[link.next].previous = index;
+    else
+        list.tail = index;
+
+    if (after != noVoice)
+        links[after].next = index;
+    else
+        list.head = index;
+
+    ++list.size;
+}
+
+std::size_t VoiceManager::indexOf (const Voice& voice) const noexcept
+{
+    return static_cast<std::size_t> (&voice - voices.data());
+}
+
+void VoiceManager::unlinkVoice (std::size_t index) noexcept
+{
+    auto& link = links[index];
+    if (link.list == ListId::none)
+        return;
+
+    auto& list = getList (link.list);
+
+    if (link.previous != noVoice)
+        links[link.previous].next = link.next;
+    else
+        list.head = link.next;
+
+    if (link.next != noVoice)
+        links[link.next].previous = link.previous;
+    else
+        list.tail = link.previous;
+
+    --list.size;
+    link.previous = noVoice;
+    link.next = noVoice;
+    link.list = ListId::none;
+}
+
+void VoiceManager::appendVoice (ListId id, std::size_t index) noexcept
+{
+    if (id == ListId::none)
+        return;
+
+    auto& list = getList (id);
+    auto& link = links[index];
+
+    link.list = id;
+    link.previous = list.tail;
+    link.next = noVoice;
+
+    if (list.tail != noVoice)
+        links[list.tail].next = index;
+    else
+        list.head = index;
+
+    list.tail = index;
+    ++list.size;
+}
+
+void VoiceManager::touchVoice (std::size_t index) noexcept
+{
+    unlinkVoice (index);
+    appendVoice (listForVoice (index), index);
+    indexVoiceNote (index);
+}
+
+void VoiceManager::unindexVoiceNote (std::size_t index) noexcept
+{
+    auto& link = links[index];
+    if (link.indexedNote < 0)
+        return;
+
+    if (link.notePrevious != noVoice)
+        links[link.notePrevious].noteNext = link.noteNext;
+    else
+        noteHeads[static_cast<std::size_t> (link.indexedNote)] = link.noteNext;
+
+    if (link.noteNext != noVoice)
+        links[link.noteNext].notePrevious = link.notePrevious;
+
+    link.notePrevious = noVoice;
+    link.noteNext = noVoice;
+    link.indexedNote = -1;
+}
+
+void VoiceManager::indexVoiceNote (std::size_t index) noexcept
+{
+    const auto& voice = voices[index];
+    const auto midiNote = voice.getState() == Voice::State::idle ? -1 : voice.getMidiNote();
+    auto& link = links[index];
+
+    if (link.indexedNote == midiNote)
+        return;
+
+    unindexVoiceNote (index);
+
+    if (midiNote < 0 || midiNote >= midiNoteCount)
+        return;
+
+    auto& head = noteHeads[static_cast<std::size_t> (midiNote)];
+    link.indexedNote = midiNote;
+    link.noteNext = head;
+
+    if (head != noVoice)
+        links[head].notePrevious = index;
+
+    head = index;
+}
+
+void VoiceManager::syncVoiceList (std::size_t index) noexcept
+{
+    if (links[index].list != listForVoice (index))
+        touchVoice (index);
+}
+
+void VoiceManager::renderList (ListId id, float* left, float* right, int numSamples, const Voice::RenderContext& context) noexcept
+{
+    // Rendering can only move a voice off to the free list or park it, so the saved successor stays valid.
+    for (auto index = getList (id).head; index != noVoice;)
+    {
+        const auto next = links[index].next;
+        voices[index].render (left, right, numSamples, context);
+        syncVoiceList (index);
+        index = next;
+    }
+}
+
+bool VoiceManager::shouldRenderInParallel (int numSamples) const noexcept
+{
+    return renderPool != nullptr
+        && renderPool->getWorkerCount() > 0
+        && numSamples >= minimumParallelSamples
+        && numSamples <= blockSize
+        && getActiveVoiceCount() + getGhostVoiceCount() >= minimumParallelVoices;
+}
+
+void VoiceManager::renderParallel (float* left, float* right, std::span<const RenderSlice> slices, int numSamples) noexcept
+{
+    // Same order as the serial path: active, releasing, retiring, then ghosts. Voices only ever
+    // leave these lists while rendering, so this order also holds for every later slice.
+    std::size_t jobCount = 0;
+    for (const auto id : { ListId::active, ListId::releasing, ListId::retiring })
+    {
+        for (auto index = getList (id).head; index != noVoice; index = links[index].next)
+            renderJobs[jobCount++] = &voices[index];
+    }
+
+    const auto voiceJobCount = jobCount;
+    for (auto& ghost : ghostVoices)
+    {
+        if (ghost.getState() != Voice::State::idle)
+            renderJobs[jobCount++] = &ghost;
+    }
+
+    const auto maxWait = std::chrono::duration<double> (renderDeadline * numSamples / sampleRate);
+    ParallelRender job { this, slices, numSamples };
+    renderPool->run (jobCount, &VoiceManager::renderJob, &job, std::chrono::duration_cast<std::chrono::nanoseconds> (maxWait));
+
+    const auto stride = static_cast<std::size_t> (blockSize);
+    for (std::size_t jobIndex = 0; jobIndex < jobCount; ++jobIndex)
+    {
+        const auto* jobLeft = jobBuffers.data() + 2 * jobIndex * stride;
+        const auto* jobRight = jobLeft + stride;
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            left[sample] += jobLeft[sample];
+            right[sample] += jobRight[sample];
+        }
+    }
+
+    for (std::size_t jobIndex = 0; jobIndex < voiceJobCount; ++jobIndex)
+        syncVoiceList (indexOf (*renderJobs[jobIndex]));
+}
+
+void VoiceManager::renderJob (void* context, std::size_t jobIndex) noexcept
+{
+    const auto& job = *static_cast<ParallelRender*> (context);
+    const auto stride = static_cast<std::size_t> (job.owner->blockSize);
+    auto* left = job.owner->jobBuffers.data() + 2 * jobIndex * stride;
+    auto* right = left + stride;
+
+    std::fill (left, left + job.numSamples, 0.0f);
+    std::fill (right, right + job.numSamples, 0.0f);
+
+    auto& voice = *job.owner->renderJobs[jobIndex];
+    auto offset = 0;
+    for (const auto& slice : job.slices)
+    {
+        // Past the deadline the voice keeps time but drops the rest of its audio for this render.
+        if (job.owner->renderPool->isOutOfTime())
+        {
+            voice.advance (job.numSamples - offset);
+            return;
+        }
+
+        voice.render (left + offset, right + offset, slice.numSamples, slice.context);
+        offset += slice.numSamples;
+    }
 }
 
-void VoiceManager::startNoteOnVoice (Voice& voice, int midiNote, float velocity, std::uint64_t newEventIndex, int unisonIndex, float detuneCents, float spreadPan, bool restartPhase)
+void VoiceManager::startNoteOnVoice (Voice& voice, int midiNote, float velocity, std::uint64_t newEventIndex, bool restartPhase)
 {
     const auto startPitch = (config.glideTimeSeconds > 0.0f && voice.getState() != Voice::State::idle)
         ? voice.getCurrentPitchHz()
         : 0.0f;
 
-    const Voice::NoteEvent event { midiNote, velocity, newEventIndex, unisonIndex, detuneCents, spreadPan };
+    const Voice::NoteEvent event {
+        midiNote, velocity, newEventIndex, unisonLaneCount(), config.unisonDetuneCents, config.unisonSpread, noteFrequency (midiNote)
+    };
     voice.startNote (event, startPitch, config.glideTimeSeconds, config.glideCurve, restartPhase);
 }
 
-Voice* VoiceManager::findVoiceForNote (int midiNote, int unisonIndex)
+Voice* VoiceManager::findVoiceForNote (int midiNote)
 {
-    auto pred = [midiNote, unisonIndex] (const auto& voice) {
-        if (voice.getState() == Voice::State::idle)
-            return false;
-
-        if (voice.getMidiNote() != midiNote)
-            return false;
+    if (midiNote < 0 || midiNote >= midiNoteCount)
+        return nullptr;
 
-        return unisonIndex < 0 || voice.getUnisonIndex() == unisonIndex;
-    };
+    for (auto index = noteHeads[static_cast<std::size_t> (midiNote)]; index != noVoice; index = links[index].noteNext)
+    {
+        if (index < activeCapacity)
+            return &voices[index];
+    }
 
-    const auto it = std::find_if (voices.begin(), voices.end(), pred);
-    return it == voices.end() ? nullptr : &(*it);
+    return nullptr;
 }
 
 Voice* VoiceManager::findStealVoice()
 {
-    auto best = voices.end();
+    // Steal order: any idle voice, then the voice that entered release first, then the active voice
+    // that started first. Releasing voices go in release-entry order, not by note start: each list
+    // is appended to as voices change state, and keeping start order would need a sorted insert on
+    // every note-off. Idle voices are only handed out while the governor's cap leaves room for
+    // another sounding voice.
+    if (freeVoices.head != noVoice && activeVoices.size + releasingVoices.size < voiceCap)
+        return &voices[freeVoices.head];
+
+    for (const auto* list : { &releasingVoices, &activeVoices, &freeVoices })
+    {
+        if (list->head != noVoice)
+            return &voices[list->head];
+    }
 
-    const auto score = [] (const Voice& voice) {
-        int stateScore = 2;
-        if (voice.getState() == Voice::State::idle)
-            stateScore = 0;
-        else if (voice.getState() == Voice::State::releasing)
-            stateScore = 1;
+    return nullptr;
+}
 
-        return std::tuple<int, std::uint64_t, int> { stateScore, voice.getStartEventIndex(), voice.getMidiNote() };
-    };
+void VoiceManager::handOffToGhost (const Voice& voice) noexcept
+{
+    if (voice.getState() == Voice::State::idle)
+        return;
+
+    // Round-robin reuse: when every ghost is busy, the one cut short is the furthest into its fade.
+    auto& ghost = ghostVoices[nextGhost];
+    nextGhost = (nextGhost + 1) % ghostVoiceCount;
+
+    ghost = voice;
+    ghost.startFadeOut (stealFadeSeconds);
+}
 
-    for (auto it = voices.begin(); it != voices.end(); ++it)
+std::size_t VoiceManager::countUnfadedVoices() const noexcept
+{
+    auto count = activeVoices.size;
+    for (auto index = releasingVoices.head; index != noVoice; index = links[index].next)
     {
-        if (best == voices.end() || score (*it) < score (*best))
-            best = it;
+        if (! voices[index].isFadingOut())
+            ++count;
     }
 
-    return best == voices.end() ? nullptr : &(*best);
+    return count;
+}
+
+std::size_t VoiceManager::findShedVoice() const noexcept
+{
+    auto quietest = noVoice;
+    for (auto index = releasingVoices.head; index != noVoice; index = links[index].next)
+    {
+        const auto& voice = voices[index];
+        if (! voice.isFadingOut() && (quietest == noVoice || voice.getOutputLevel() < voices[quietest].getOutputLevel()))
+            quietest = index;
+    }
+
+    if (quietest != noVoice)
+        return quietest;
+
+    for (auto index = activeVoices.head; index != noVoice; index = links[index].next)
+    {
+        if (! voices[index].isFadingOut())
+            return index;
+    }
+
+    return noVoice;
+}
+
+void VoiceManager::shedVoicesOverCap() noexcept
+{
+    for (auto sounding = countUnfadedVoices(); sounding > voiceCap; --sounding)
+    {
+        const auto index = findShedVoice();
+        if (index == noVoice)
+            return;
+
+        voices[index].startFadeOut (governor.fadeTimeSeconds);
+        touchVoice (index);
+    }
 }
 
 void VoiceManager::releaseVoicesForNote (int midiNote)
 {
-    for (auto& voice : voices)
+    for (auto index = noteHeads[static_cast<std::size_t> (midiNote)]; index != noVoice;)
     {
-        if (voice.getMidiNote() == midiNote && voice.isKeyHeld())
+        // Releasing keeps the voice on this note's chain, but read the successor first anyway.
+        const auto next = links[index].noteNext;
+        auto& voice = voices[index];
+
+        if (voice.isKeyHeld())
+        {
             voice.startRelease (config.releaseTimeSeconds);
+            touchVoice (index);
+        }
+
+        index = next;
     }
 }
 
 void VoiceManager::pushHeldNote (int midiNote, float velocity)
 {
     removeHeldNote (midiNote);
-    heldNotes.push_back ({ midiNote, velocity, eventCounter });
+
+    auto& slot = heldNoteSlots[static_cast<std::size_t> (midiNote)];
+    slot.held = true;
+    slot.velocity = velocity;
+    slot.eventIndex = eventCounter;
+    slot.previous = heldNoteTail;
+    slot.next = -1;
+
+    if (heldNoteTail >= 0)
+        heldNoteSlots[static_cast<std::size_t> (heldNoteTail)].next = midiNote;
+    else
+        heldNoteHead = midiNote;
+
+    heldNoteTail = midiNote;
 }
 
 void VoiceManager::removeHeldNote (int midiNote)
 {
-    heldNotes.erase (std::remove_if (heldNotes.begin(), heldNotes.end(), [midiNote] (const HeldNote& note) {
-        return note.midiNote == midiNote;
-    }), heldNotes.end());
+    auto& slot = heldNoteSlots[static_cast<std::size_t> (midiNote)];
+    if (! slot.held)
+        return;
+
+    if (slot.previous >= 0)
+        heldNoteSlots[static_cast<std::size_t> (slot.previous)].next = slot.next;
+    else
+        heldNoteHead = slot.next;
+
+    if (slot.next >= 0)
+        heldNoteSlots[static_cast<std::size_t> (slot.next)].previous = slot.previous;
+    else
+        heldNoteTail = slot.previous;
+
+    slot = {};
 }
 
 VoiceManager::HeldNote VoiceManager::latestHeldNote() const
 {
-    if (heldNotes.empty())
+    if (heldNoteTail < 0)
         return {};
 
-    return heldNotes.back();
+    const auto& slot = heldNoteSlots[static_cast<std::size_t> (heldNoteTail)];
+    return { heldNoteTail, slot.velocity, slot.eventIndex };
+}
+
+void VoiceManager::clearHeldNotes() noexcept
+{
+    heldNoteSlots.fill ({});
+    heldNoteHead = -1;
+    heldNoteTail = -1;
 }
 } // namespace secretsynth::dsp::voice
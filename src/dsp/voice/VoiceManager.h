@@ -1,9 +1,14 @@
 #pragma once
 
+#include "RenderThreadPool.h"
 #include "Voice.h"
+#include "../tuning/TuningTable.h"
 
+#include <array>
 #include <cstddef>
 #include <cstdint>
+#include <limits>
+#include <span>
 #include <vector>
 
 namespace secretsynth::dsp::voice
@@ -31,25 +36,137 @@ public:
         GlideCurve glideCurve { GlideCurve::linear };
     };
 
+    // CPU-budget polyphony governor. The owner reports how long each render took; when that exceeds
+    // budgetFraction of the block's real-time duration for overloadBlocks consecutive blocks, the
+    // voice cap drops in proportion to the smallest overshoot in that run and the quietest releasing
+    // voices (then the oldest held ones) are faded out. A single slow block never sheds, so page
+    // faults and host hiccups do not cut held notes. After recoveryBlocks consecutive blocks under
+    // recoveryFraction of the budget the cap grows by one voice again.
+    struct GovernorConfig
+    {
+        float budgetFraction { 0.0f }; // 0 disables the governor
+        int overloadBlocks { 4 };      // at least 2
+        float recoveryFraction { 0.5f };
+        int recoveryBlocks { 8 };
+        std::size_t minimumVoices { 4 };
+        float fadeTimeSeconds { 0.003f };
+    };
+
+    static constexpr std::size_t defaultPoolSize = 64;
+
+    // A stolen voice's sound is copied into a ghost that fades it out over stealFadeSeconds while
+    // the slot starts the new note, so each steal costs at most one extra voice render for a few ms.
+    static constexpr std::size_t ghostVoiceCount = 4;
+    static constexpr float stealFadeSeconds = 0.003f;
+
+    // With a render pool attached, renders with enough sounding voices render each voice into its own
+    // stereo buffer pair on the pool, and the buffers are summed in list order so the output is bit-identical
+    // to the serial path. Renders shorter than one voice control block or with fewer voices stay on the
+    // calling thread. A parallel render that runs past deadlineFraction of its real-time duration
+    // cuts the voices still rendering short: they skip ahead silently to the end of the render.
+    static constexpr int minimumParallelVoices = 8;
+    static constexpr int minimumParallelSamples = Voice::controlBlockSize;
+    static constexpr double defaultRenderDeadline = 0.9;
+
+    // One control-rate slice of a longer render and the context that applies to it.
+    struct RenderSlice
+    {
+        int numSamples { 0 };
+        Voice::RenderContext context {};
+    };
+
     VoiceManager();
     explicit VoiceManager (Config newConfig);
 
     void setConfig (const Config& newConfig);
     [[nodiscard]] const Config& getConfig() const noexcept { return config; }
 
-    void prepare (double newSampleRate, int newBlockSize);
+    // Allocates the voice pool on first use (or when poolSize changes). Config changes afterwards
+    // only move the active-capacity window and never reallocate.
+    void prepare (double newSampleRate, int newBlockSize, std::size_t poolSize = defaultPoolSize);
     void reset();
 
     void noteOn (int midiNote, float velocity);
     void noteOff (int midiNote);
     void allNotesOff();
 
+    void setGovernorConfig (const GovernorConfig& newConfig) noexcept;
+    [[nodiscard]] const GovernorConfig& getGovernorConfig() const noexcept { return governor; }
+    void reportRenderTime (double renderSeconds, int numSamples) noexcept;
+    [[nodiscard]] std::size_t getVoiceCap() const noexcept { return voiceCap; }
+
+    // The pool is not owned and must outlive its use here; nullptr renders serially.
+    void setRenderThreadPool (RenderThreadPool* newPool, double deadlineFraction = defaultRenderDeadline) noexcept
+    {
+        renderPool = newPool;
+        renderDeadline = deadlineFraction;
+    }
+
+    // Note frequencies come from this table from the next note-on; keys it leaves unmapped are
+    // ignored. Not owned; nullptr uses twelve-tone equal temperament.
+    void setTuning (const tuning::TuningTable* newTuning) noexcept { tuningTable = newTuning; }
+
     void advance (int numSamples);
+    void render (float* left, float* right, int numSamples, const Voice::RenderContext& context) noexcept;
+
+    // Renders the slices back to back into left/right. On the pool this is a single dispatch: each
+    // job carries its voice through every slice, so workers are woken once per call, not per slice.
+    void render (float* left, float* right, std::span<const RenderSlice> slices) noexcept;
+
+    [[nodiscard]] int getActiveVoiceCount() const noexcept;
+    [[nodiscard]] int getGhostVoiceCount() const noexcept;
+    [[nodiscard]] const Voice* getNewestVoice() const noexcept;
+
+    // True when no voice, releasing voice or ghost can produce output; render then adds nothing.
+    [[nodiscard]] bool isIdle() const noexcept;
 
     [[nodiscard]] const std::vector<Voice>& getVoices() const noexcept { return voices; }
-    [[nodiscard]] std::vector<Voice>& getVoices() noexcept { return voices; }
+    [[nodiscard]] std::size_t getActiveCapacity() const noexcept { return activeCapacity; }
 
 private:
+    static constexpr std::size_t noVoice = std::numeric_limits<std::size_t>::max();
+    static constexpr int midiNoteCount = 128;
+
+    // Voices are threaded through intrusive lists, one per state. A voice is appended when it
+    // enters a state, so each list is ordered oldest-first and steal candidates sit at the heads.
+    // Sounding voices outside the active-capacity window sit on the retiring list: they finish
+    // their release but are never reused, and park (no list) once idle.
+    enum class ListId : std::uint8_t
+    {
+        none,
+        free,
+        releasing,
+        active,
+        retiring
+    };
+
+    // A second intrusive list per MIDI note chains every sounding voice playing that note, so
+    // note-off and retrigger lookups cost O(voices on that note) instead of O(voices).
+    struct VoiceLink
+    {
+        std::size_t previous { noVoice };
+        std::size_t next { noVoice };
+        ListId list { ListId::none };
+
+        std::size_t notePrevious { noVoice };
+        std::size_t noteNext { noVoice };
+        int indexedNote { -1 };
+    };
+
+    struct VoiceList
+    {
+        std::size_t head { noVoice };
+        std::size_t tail { noVoice };
+        std::size_t size { 0 };
+    };
+
+    struct ParallelRender
+    {
+        VoiceManager* owner { nullptr };
+        std::span<const RenderSlice> slices;
+        int numSamples { 0 };
+    };
+
     struct HeldNote
     {
         int midiNote { -1 };
@@ -57,23 +174,76 @@ private:
         std::uint64_t eventIndex { 0 };
     };
 
+    // Held keys form a doubly linked list threaded through a fixed slot per MIDI note, ordered
+    // by press time, so push/remove/latest are O(1) and never allocate.
+    struct HeldNoteSlot
+    {
+        int previous { -1 };
+        int next { -1 };
+        float velocity { 0.0f };
+        std::uint64_t eventIndex { 0 };
+        bool held { false };
+    };
+
     [[nodiscard]] std::size_t targetVoiceCount() const;
     [[nodiscard]] bool isMonophonicMode() const;
-    [[nodiscard]] int requiredUnisonCount() const;
+    [[nodiscard]] int unisonLaneCount() const;
+    [[nodiscard]] float noteFrequency (int midiNote) const noexcept;
 
-    void ensureVoiceCount();
-    void startNoteOnVoice (Voice& voice, int midiNote, float velocity, std::uint64_t eventIndex, int unisonIndex, float detuneCents, float spreadPan, bool restartPhase);
-    Voice* findVoiceForNote (int midiNote, int unisonIndex = -1);
+    void applyActiveCapacity();
+    void rebuildVoiceLists() noexcept;
+    [[nodiscard]] VoiceList& getList (ListId id) noexcept;
+    [[nodiscard]] ListId listForVoice (std::size_t index) const noexcept;
+    void insertVoiceByAge (ListId id, std::size_t index) noexcept;
+    [[nodiscard]] std::size_t indexOf (const Voice& voice) const noexcept;
+    void unlinkVoice (std::size_t index) noexcept;
+    void appendVoice (ListId id, std::size_t index) noexcept;
+    void touchVoice (std::size_t index) noexcept;
+    void unindexVoiceNote (std::size_t index) noexcept;
+    void indexVoiceNote (std::size_t index) noexcept;
+    void syncVoiceList (std::size_t index) noexcept;
+    void renderList (ListId id, float* left, float* right, int numSamples, const Voice::RenderContext& context) noexcept;
+    [[nodiscard]] bool shouldRenderInParallel (int numSamples) const noexcept;
+    void renderParallel (float* left, float* right, std::span<const RenderSlice> slices, int numSamples) noexcept;
+    static void renderJob (void* context, std::size_t jobIndex) noexcept;
+    void startNoteOnVoice (Voice& voice, int midiNote, float velocity, std::uint64_t eventIndex, bool restartPhase);
+    Voice* findVoiceForNote (int midiNote);
     Voice* findStealVoice();
+    void handOffToGhost (const Voice& voice) noexcept;
+    [[nodiscard]] std::size_t countUnfadedVoices() const noexcept;
+    [[nodiscard]] std::size_t findShedVoice() const noexcept;
+    void shedVoicesOverCap() noexcept;
     void releaseVoicesForNote (int midiNote);
 
     void pushHeldNote (int midiNote, float velocity);
     void removeHeldNote (int midiNote);
     [[nodiscard]] HeldNote latestHeldNote() const;
+    void clearHeldNotes() noexcept;
 
     Config config {};
     std::vector<Voice> voices;
-    std::vector<HeldNote> heldNotes;
+    std::vector<VoiceLink> links;
+    std::array<Voice, ghostVoiceCount> ghostVoices {};
+    std::size_t nextGhost { 0 };
+    RenderThreadPool* renderPool { nullptr };
+    double renderDeadline { defaultRenderDeadline };
+    const tuning::TuningTable* tuningTable { nullptr };
+    std::vector<Voice*> renderJobs;
+    std::vector<float> jobBuffers;
+    VoiceList freeVoices;
+    VoiceList releasingVoices;
+    VoiceList activeVoices;
+    VoiceList retiringVoices;
+    std::size_t activeCapacity { 0 };
+    GovernorConfig governor {};
+    std::size_t voiceCap { 0 };
+    int headroomBlocks { 0 };
+    int overloadedBlocks { 0 };
+    double sustainedLoad { 0.0 }; // smallest load of the current overloaded run
+    std::array<std::size_t, midiNoteCount> noteHeads {};
+    std::array<HeldNoteSlot, midiNoteCount> heldNoteSlots {};
+    int heldNoteHead { -1 };
+    int heldNoteTail { -1 };
     std::uint64_t eventCounter { 1 };
     double sampleRate { 44100.0 };
     int blockSize { 0 };
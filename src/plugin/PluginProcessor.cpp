@@ -1,7 +1,19 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "../dsp/trace/Trace.h"
 
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#if SECRETSYNTH_TRACING
+    #include <fstream>
+#endif
 
 namespace secretsynth::plugin
 {
@@ -14,17 +26,62 @@ juce::NormalisableRange<float> makeRange (const parameters::ParameterSpec& spec)
 
     return { spec.minimum, spec.maximum };
 }
-} // namespace
 
-float SecretSynthAudioProcessor::softLimit (float sample) noexcept
+// Continuous parameters ramp to new values instead of stepping; the rest apply at the next block.
+constexpr std::array smoothedParameterIds {
+    parameters::ParameterId::oscillatorPdAmount, parameters::ParameterId::oscillatorPdShape, parameters::ParameterId::oscillatorTune,
+    parameters::ParameterId::oscillatorFine,     parameters::ParameterId::oscillatorMix,     parameters::ParameterId::filterCutoffHz,
+    parameters::ParameterId::filterResonance,    parameters::ParameterId::outputGain,
+};
+
+constexpr float parameterRampSeconds = 0.02f;
+
+// Reported on top of the amp release: covers the filter ringing out and the steal fades.
+constexpr double tailMarginSeconds = 0.05;
+
+// Host blocks are rendered on a fixed grid of sub-blocks, split further only at MIDI events, so
+// control-rate work runs at the same rate whatever buffer size the host uses.
+constexpr int subBlockSize = secretsynth::dsp::voice::Voice::controlBlockSize;
+
+float toUnipolar (float value) noexcept
+{
+    return 0.5f * (value + 1.0f);
+}
+
+// LFOs are evaluated once per sub-block; the buffers voices read are filled by interpolation.
+void fillControlRamp (float* output, float startValue, float endValue, int numSamples) noexcept
 {
-    return std::tanh (sample);
+    const auto step = (endValue - startValue) / static_cast<float> (numSamples);
+    for (int i = 0; i < numSamples; ++i)
+        output[i] = startValue + step * static_cast<float> (i + 1);
 }
+} // namespace
 
 SecretSynthAudioProcessor::SecretSynthAudioProcessor()
     : AudioProcessor (BusesProperties().withOutput ("Output", juce::AudioChannelSet::stereo(), true)),
       valueTreeState (*this, nullptr, "SecretSynthParameters", createParameterLayout())
 {
+    // Ids are resolved here once: a juce::String allocates, so the audio thread reads the cached
+    // pointers instead of looking parameters up by name.
+    for (const auto& spec : parameters::parameterSpecs)
+    {
+        const juce::String stableId (spec.stableId.data());
+        rawParameterValues[static_cast<std::size_t> (spec.id)] = valueTreeState.getRawParameterValue (stableId);
+        valueTreeState.addParameterListener (stableId, this);
+    }
+
+    using secretsynth::dsp::mod::Destination;
+    using secretsynth::dsp::mod::Source;
+    routeState.addRoute ({ Source::lfo1, Destination::pdAmount, 0.25f, true });
+    routeState.addRoute ({ Source::modEnv, Destination::filterCutoff, 0.8f, false });
+    routeState.addRoute ({ Source::ampEnv, Destination::amp, 1.0f, false });
+    sharedRoutes.publish (routeState.getRouteSet());
+}
+
+SecretSynthAudioProcessor::~SecretSynthAudioProcessor()
+{
+    for (const auto& spec : parameters::parameterSpecs)
+        valueTreeState.removeParameterListener (juce::String (spec.stableId.data()), this);
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout SecretSynthAudioProcessor::createParameterLayout()
@@ -45,45 +102,118 @@ juce::AudioProcessorValueTreeState::ParameterLayout SecretSynthAudioProcessor::c
 
 float SecretSynthAudioProcessor::getParameterValue (parameters::ParameterId id) const noexcept
 {
-    const auto& spec = parameters::getSpec (id);
-    if (const auto* value = valueTreeState.getRawParameterValue (juce::String (spec.stableId.data())))
+    if (const auto* value = rawParameterValues[static_cast<std::size_t> (id)])
         return value->load();
 
-    return spec.defaultValue;
+    return parameters::getSpec (id).defaultValue;
+}
+
+void SecretSynthAudioProcessor::parameterChanged (const juce::String& parameterID, float)
+{
+    // Called on whichever thread changed the value; compares in place so nothing allocates.
+    for (const auto& spec : parameters::parameterSpecs)
+    {
+        if (parameterID == spec.stableId.data())
+        {
+            parameterChanges.markChanged (spec.id);
+            return;
+        }
+    }
 }
 
 void SecretSynthAudioProcessor::applyStateToEngine()
 {
-    oscillator.setFrequency (getParameterValue (parameters::ParameterId::oscillatorFrequency));
-    oscillator.setPdAmount (getParameterValue (parameters::ParameterId::oscillatorPdAmount));
-    oscillator.setPdShape (getParameterValue (parameters::ParameterId::oscillatorPdShape));
-    oscillator.setTune (getParameterValue (parameters::ParameterId::oscillatorTune));
-    oscillator.setFine (getParameterValue (parameters::ParameterId::oscillatorFine));
-    oscillator.setMix (getParameterValue (parameters::ParameterId::oscillatorMix));
+    using parameters::ParameterId;
 
-    filter.setCutoffHz (getParameterValue (parameters::ParameterId::filterCutoffHz));
-    filter.setResonance (getParameterValue (parameters::ParameterId::filterResonance));
+    // Routes loaded on the message thread are picked up here; copying them never allocates.
+    if (const auto& routes = sharedRoutes.acquire(); &routes != appliedRoutes)
+    {
+        modulationMatrix.setRoutes (routes);
+        appliedRoutes = &routes;
+    }
 
-    modulationEngine.lfo1.setRateHz (getParameterValue (parameters::ParameterId::modLfo1RateHz));
-    modulationEngine.lfo2.setRateHz (getParameterValue (parameters::ParameterId::modLfo2RateHz));
+    const auto changes = parameterChanges.takeChanges();
+    if (! changes.any())
+        return;
 
-    modulationEngine.ampEnv.setParameters ({ getParameterValue (parameters::ParameterId::ampAttackSeconds),
-                                             0.12f,
-                                             0.9f,
-                                             getParameterValue (parameters::ParameterId::ampReleaseSeconds) });
+    for (const auto id : smoothedParameterIds)
+    {
+        if (changes.contains (id))
+            smoothedParameters.setTargetValue (id, getParameterValue (id));
+    }
 
-    oscillatorMixGain = getParameterValue (parameters::ParameterId::outputGain);
+    if (changes.contains (ParameterId::ampAttackSeconds) || changes.contains (ParameterId::ampReleaseSeconds))
+    {
+        voiceParameters.ampEnvelope.attackSeconds = getParameterValue (ParameterId::ampAttackSeconds);
+        voiceParameters.ampEnvelope.releaseSeconds = getParameterValue (ParameterId::ampReleaseSeconds);
+        bumpParameterRevision();
+    }
+
+    if (changes.contains (ParameterId::modLfo1RateHz))
+        modulationEngine.lfo1.setRateHz (getParameterValue (ParameterId::modLfo1RateHz));
+
+    if (changes.contains (ParameterId::modLfo2RateHz))
+        modulationEngine.lfo2.setRateHz (getParameterValue (ParameterId::modLfo2RateHz));
+
+    if (! changes.contains (ParameterId::performanceVoices) && ! changes.contains (ParameterId::ampReleaseSeconds))
+        return;
+
+    const auto maxVoices = static_cast<std::size_t> (std::lround (getParameterValue (parameters::ParameterId::performanceVoices)));
+    const auto releaseTimeSeconds = voiceParameters.ampEnvelope.releaseSeconds;
+    const auto& currentConfig = voiceManager.getConfig();
+
+    if (currentConfig.maxVoices != maxVoices || ! juce::exactlyEqual (currentConfig.releaseTimeSeconds, releaseTimeSeconds))
+    {
+        auto config = currentConfig;
+        config.maxVoices = maxVoices;
+        config.releaseTimeSeconds = releaseTimeSeconds;
+        voiceManager.setConfig (config);
+    }
+}
+
+void SecretSynthAudioProcessor::advanceSmoothedParameters (int numSamples)
+{
+    using parameters::ParameterId;
+
+    smoothedParameters.process (numSamples);
+
+    // Ramping pd amount, cutoff and gain reach the engine per sample through their ramp buffers;
+    // the fields below hold the value at the end of this block.
+    voiceParameters.pdAmount = smoothedParameters.getValue (ParameterId::oscillatorPdAmount);
+    voiceParameters.filterCutoffHz = smoothedParameters.getValue (ParameterId::filterCutoffHz);
+    oscillatorMixGain = smoothedParameters.getValue (ParameterId::outputGain);
+
+    auto changed = false;
+    const auto follow = [&] (ParameterId id, float& target)
+    {
+        const auto value = smoothedParameters.getValue (id);
+        changed = changed || ! juce::exactlyEqual (value, target);
+        target = value;
+    };
+
+    follow (ParameterId::oscillatorPdShape, voiceParameters.pdShape);
+    follow (ParameterId::oscillatorTune, voiceParameters.tuneSemitones);
+    follow (ParameterId::oscillatorFine, voiceParameters.fineCents);
+    follow (ParameterId::oscillatorMix, voiceParameters.oscillatorMix);
+    follow (ParameterId::filterResonance, voiceParameters.filterResonance);
+
+    if (changed)
+        bumpParameterRevision();
 }
 
-void SecretSynthAudioProcessor::prepareToPlay (double sampleRate, int)
+void SecretSynthAudioProcessor::bumpParameterRevision() noexcept
+{
+    // Voices re-apply their oscillator, filter and envelope settings only when this moves.
+    if (++voiceParameters.revision == 0)
+        voiceParameters.revision = 1;
+}
+
+void SecretSynthAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
     modulationEngine.setSampleRate (sampleRate);
     modulationEngine.reset();
-
-    modulationEngine.ampEnv.setParameters ({ 0.005f, 0.12f, 0.9f, 0.3f });
-    modulationEngine.modEnv.setParameters ({ 0.02f, 0.3f, 0.0f, 0.4f });
-    modulationEngine.ampEnv.noteOn();
-    modulationEngine.modEnv.noteOn();
+    cpuLoadMeter.setSampleRate (sampleRate);
+    cpuLoadMeter.reset();
 
     modulationEngine.lfo1.setRateMode (secretsynth::dsp::mod::Lfo::RateMode::tempoSync);
     modulationEngine.lfo1.setSyncDivision (secretsynth::dsp::mod::Lfo::SyncDivision::eighth);
@@ -94,29 +224,58 @@ void SecretSynthAudioProcessor::prepareToPlay (double sampleRate, int)
 
     modulationMatrix.setSampleRate (sampleRate);
     modulationMatrix.setDestinationSmoothingTimeSeconds (0.015f);
-    modulationMatrix.clearRoutes();
-    modulationMatrix.addRoute ({ secretsynth::dsp::mod::Source::lfo1, secretsynth::dsp::mod::Destination::pdAmount, 0.25f, true });
-    modulationMatrix.addRoute ({ secretsynth::dsp::mod::Source::modEnv, secretsynth::dsp::mod::Destination::filterCutoff, 0.8f, false });
-    modulationMatrix.addRoute ({ secretsynth::dsp::mod::Source::ampEnv, secretsynth::dsp::mod::Destination::amp, 1.0f, false });
-
-    oscillator.prepare (sampleRate);
-    oscillator.reset();
-    oscillator.setQualityMode (secretsynth::dsp::osc::PhaseWarpOscillator::QualityMode::high);
-
-    filter.prepare (sampleRate);
-    filter.reset();
-    filter.setMode (secretsynth::dsp::filter::MultiModeFilter::Mode::lowPass);
-    filter.setKeyTracking (0.5f);
-    filter.setKeyTrackingReferenceHz (440.0f);
-
-    filterPosition = FilterPosition::postOscMix;
-    activeVoices = 1;
-    lastKeyFrequencyHz = 220.0f;
 
+    voiceParameters = {};
+    voiceParameters.oscillatorQuality = secretsynth::dsp::osc::PhaseWarpOscillator::QualityMode::high;
+    voiceParameters.filterKeyTracking = 0.5f;
+
+    const auto maxBlockSize = juce::jmax (1, samplesPerBlock);
+    lfo1Buffer.assign (static_cast<std::size_t> (maxBlockSize), 0.0f);
+    lfo2Buffer.assign (static_cast<std::size_t> (maxBlockSize), 0.0f);
+    pdAmountRampBuffer.assign (static_cast<std::size_t> (maxBlockSize), 0.0f);
+    cutoffRampBuffer.assign (static_cast<std::size_t> (maxBlockSize), 0.0f);
+    gainRampBuffer.assign (static_cast<std::size_t> (maxBlockSize), 0.0f);
+    mixBus.prepare (maxBlockSize);
+
+    // A segment that starts off the sub-block grid has one partial sub-block at each end.
+    const auto maxSlices = static_cast<std::size_t> (maxBlockSize / subBlockSize + 2);
+    sliceParameters.assign (maxSlices, {});
+    renderSlices.assign (maxSlices, {});
+
+    smoothedParameters.prepare (sampleRate, maxBlockSize);
+    for (const auto id : smoothedParameterIds)
+        smoothedParameters.setRampTimeSeconds (id, parameterRampSeconds);
+
+    // voiceParameters was just reset, so every parameter has to be applied again, without ramps,
+    // and the current routes are copied in as well.
+    parameterChanges.markAllChanged();
+    appliedRoutes = nullptr;
     applyStateToEngine();
+    smoothedParameters.finishRamps();
+    advanceSmoothedParameters (0);
+
+    // Workers are created once, off the audio thread; small hosts and machines stay single-threaded.
+    // Their realtime policy is sized from the first callback period the host announces.
+    if (renderThreadPool == nullptr)
+        renderThreadPool = std::make_unique<secretsynth::dsp::voice::RenderThreadPool> (
+            juce::jlimit (0, 3, static_cast<int> (std::thread::hardware_concurrency()) / 2 - 1),
+            maxBlockSize / sampleRate);
+
+    voiceManager.prepare (sampleRate, maxBlockSize);
+    voiceManager.setRenderThreadPool (renderThreadPool.get());
+    voiceManager.setGovernorConfig ({ .budgetFraction = 0.7f });
+    voiceManager.reset();
 }
 
-void SecretSynthAudioProcessor::releaseResources() {}
+void SecretSynthAudioProcessor::releaseResources()
+{
+#if SECRETSYNTH_TRACING
+    // Tracing builds dump everything recorded so far whenever the host stops processing.
+    const auto traceFile = juce::File::getSpecialLocation (juce::File::tempDirectory).getChildFile ("SecretSynth.trace.json");
+    std::ofstream trace (traceFile.getFullPathName().toStdString());
+    secretsynth::dsp::trace::writeChromeTrace (trace);
+#endif
+}
 
 bool SecretSynthAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
 {
@@ -124,73 +283,236 @@ bool SecretSynthAudioProcessor::isBusesLayoutSupported (const BusesLayout& layou
         || layouts.getMainOutputChannelSet() == juce::AudioChannelSet::stereo();
 }
 
-void SecretSynthAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
+void SecretSynthAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
+    SECRETSYNTH_TRACE_SCOPE ("processBlock");
     juce::ScopedNoDenormals noDenormals;
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+    stageTicks.fill (0);
+    stageStartTicks = startTicks;
 
     applyStateToEngine();
+    voiceManager.setTuning (&tuning.acquire());
+    endStage (telemetry::Stage::modulation);
+
+    const auto numSamples = buffer.getNumSamples();
+    if (midiMessages.isEmpty() && voiceManager.isIdle())
+    {
+        skipSilentBlock (buffer);
+        endStage (telemetry::Stage::output);
 
-    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
-        buffer.clear (channel, 0, buffer.getNumSamples());
+        // The buffer was just cleared, so its peaks are known without scanning it.
+        publishTelemetry (numSamples, 0.0f, 0.0f, juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks));
+        return;
+    }
 
-    for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+    auto position = 0;
+
+    // Render up to each event's timestamp, then apply it, so note changes land on their exact sample.
+    for (const auto metadata : midiMessages)
     {
-        const auto amp = modulationEngine.ampEnv.processSample();
-        const auto mod = modulationEngine.modEnv.processSample();
-        const auto lfo1 = 0.5f * (modulationEngine.lfo1.processSample() + 1.0f);
-        const auto lfo2 = 0.5f * (modulationEngine.lfo2.processSample() + 1.0f);
-
-        std::array<float, static_cast<std::size_t> (secretsynth::dsp::mod::Source::count)> sources {};
-        sources[static_cast<std::size_t> (secretsynth::dsp::mod::Source::ampEnv)] = amp;
-        sources[static_cast<std::size_t> (secretsynth::dsp::mod::Source::modEnv)] = mod;
-        sources[static_cast<std::size_t> (secretsynth::dsp::mod::Source::lfo1)] = lfo1;
-        sources[static_cast<std::size_t> (secretsynth::dsp::mod::Source::lfo2)] = lfo2;
-
-        const auto destinations = modulationMatrix.process (sources);
-        const auto pdAmountMod = destinations[static_cast<std::size_t> (secretsynth::dsp::mod::Destination::pdAmount)];
-        const auto ampMod = destinations[static_cast<std::size_t> (secretsynth::dsp::mod::Destination::amp)];
-        const auto cutoffMod = destinations[static_cast<std::size_t> (secretsynth::dsp::mod::Destination::filterCutoff)];
-        activeVoices = (ampMod > 1.0e-4f ? 1 : 0);
-
-        const auto basePdAmount = getParameterValue (parameters::ParameterId::oscillatorPdAmount);
-        const auto baseCutoff = getParameterValue (parameters::ParameterId::filterCutoffHz);
-        oscillator.setPdAmount (juce::jlimit (0.0f, 1.0f, basePdAmount + pdAmountMod));
-        filter.setCutoffHz (juce::jlimit (20.0f, 20000.0f, baseCutoff + 8000.0f * cutoffMod));
-
-        float oscillatorSample = oscillator.renderSample() * 0.1f;
-
-        if (activeVoices <= 0)
+        const auto eventPosition = juce::jlimit (position, numSamples, metadata.samplePosition);
+        renderVoices (buffer, position, eventPosition - position);
+        handleMidiMessage (metadata.getMessage());
+        endStage (telemetry::Stage::voices);
+        position = eventPosition;
+    }
+
+    renderVoices (buffer, position, numSamples - position);
+
+    const auto renderSeconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+    voiceManager.reportRenderTime (renderSeconds, numSamples);
+    publishTelemetry (buffer, renderSeconds);
+}
+
+void SecretSynthAudioProcessor::endStage (telemetry::Stage stage) noexcept
+{
+    const auto now = juce::Time::getHighResolutionTicks();
+    stageTicks[static_cast<std::size_t> (stage)] += now - stageStartTicks;
+    stageStartTicks = now;
+}
+
+void SecretSynthAudioProcessor::skipSilentBlock (juce::AudioBuffer<float>& buffer)
+{
+    // Nothing is sounding and nothing starts in this block, so the render pipeline would only
+    // write zeros. Ramps jump to their targets because no voice can hear them move, and the LFOs
+    // keep their phase so tempo-synced modulation stays on the beat.
+    buffer.clear();
+
+    if (std::any_of (smoothedParameterIds.begin(), smoothedParameterIds.end(), [this] (auto id) { return smoothedParameters.isRamping (id); }))
+    {
+        smoothedParameters.finishRamps();
+        advanceSmoothedParameters (0);
+    }
+
+    const auto numSamples = buffer.getNumSamples();
+    modulationEngine.lfo1.advance (numSamples);
+    modulationEngine.lfo2.advance (numSamples);
+}
+
+void SecretSynthAudioProcessor::publishTelemetry (const juce::AudioBuffer<float>& buffer, double renderSeconds) noexcept
+{
+    const auto numChannels = buffer.getNumChannels();
+    const auto numSamples = buffer.getNumSamples();
+    const auto peakLeft = numChannels > 0 ? buffer.getMagnitude (0, 0, numSamples) : 0.0f;
+    const auto peakRight = numChannels > 1 ? buffer.getMagnitude (1, 0, numSamples) : peakLeft;
+    publishTelemetry (numSamples, peakLeft, peakRight, renderSeconds);
+}
+
+void SecretSynthAudioProcessor::publishTelemetry (int numSamples, float peakLeft, float peakRight, double renderSeconds) noexcept
+{
+    using secretsynth::dsp::mod::Destination;
+
+    telemetry::TelemetryFrame frame;
+    if (const auto* newest = voiceManager.getNewestVoice())
+    {
+        const auto& modulation = newest->getLastModulation();
+        frame.pdAmountModulation = modulation[static_cast<std::size_t> (Destination::pdAmount)];
+        frame.filterCutoffModulation = modulation[static_cast<std::size_t> (Destination::filterCutoff)];
+        frame.ampModulation = modulation[static_cast<std::size_t> (Destination::amp)];
+    }
+
+    frame.numSamples = numSamples;
+    frame.peakLeft = peakLeft;
+    frame.peakRight = peakRight;
+    frame.activeVoices = voiceManager.getActiveVoiceCount();
+    frame.renderSeconds = static_cast<float> (renderSeconds);
+
+    telemetry::StageSeconds stageSeconds {};
+    for (std::size_t stage = 0; stage < telemetry::stageCount; ++stage)
+    {
+        stageSeconds[stage] = juce::Time::highResolutionTicksToSeconds (stageTicks[stage]);
+        frame.stageSeconds[stage] = static_cast<float> (stageSeconds[stage]);
+    }
+
+    frame.load = cpuLoadMeter.recordBlock (frame.numSamples, renderSeconds, stageSeconds);
+
+    // A full FIFO means the editor is closed or stalled; its frames are not worth blocking for.
+    telemetryFifo.push (frame);
+}
+
+void SecretSynthAudioProcessor::handleMidiMessage (const juce::MidiMessage& message)
+{
+    if (message.isNoteOn())
+        voiceManager.noteOn (message.getNoteNumber(), message.getFloatVelocity());
+    else if (message.isNoteOff())
+        voiceManager.noteOff (message.getNoteNumber());
+    else if (message.isAllNotesOff() || message.isAllSoundOff())
+        voiceManager.allNotesOff();
+}
+
+void SecretSynthAudioProcessor::renderVoices (juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    using parameters::ParameterId;
+
+    const auto capacity = mixBus.getCapacity();
+    const auto numChannels = juce::jmin (buffer.getNumChannels(), 2);
+
+    while (numSamples > 0 && capacity > 0)
+    {
+        const auto segment = juce::jmin (numSamples, capacity);
+
+        // Control pass: LFOs, smoothed parameters and ramps still advance per sub-block; each
+        // sub-block's values are kept so the voices can render the whole segment in one go.
+        std::size_t sliceCount = 0;
+        auto gainRamping = false;
+        for (int offset = 0; offset < segment; ++sliceCount)
         {
-            oscillatorSample = 0.0f;
-            filter.reset();
+            const auto chunk = juce::jmin (segment - offset, subBlockSize - (startSample + offset) % subBlockSize);
+
+            auto& lfo1 = modulationEngine.lfo1;
+            auto& lfo2 = modulationEngine.lfo2;
+            fillControlRamp (lfo1Buffer.data() + offset, toUnipolar (lfo1.getCurrentValue()), toUnipolar (lfo1.advance (chunk)), chunk);
+            fillControlRamp (lfo2Buffer.data() + offset, toUnipolar (lfo2.getCurrentValue()), toUnipolar (lfo2.advance (chunk)), chunk);
+
+            advanceSmoothedParameters (chunk);
+
+            // Ramps are only valid until the next process(), so they are copied out per sub-block.
+            const auto keepRamp = [&] (ParameterId id, std::vector<float>& destination) -> const float*
+            {
+                const auto* ramp = smoothedParameters.getRamp (id);
+                if (ramp == nullptr)
+                    return nullptr;
+
+                std::copy_n (ramp, chunk, destination.data() + offset);
+                return destination.data() + offset;
+            };
+
+            if (keepRamp (ParameterId::outputGain, gainRampBuffer) != nullptr)
+                gainRamping = true;
+            else
+                std::fill_n (gainRampBuffer.data() + offset, chunk, oscillatorMixGain);
+
+            sliceParameters[sliceCount] = voiceParameters;
+            renderSlices[sliceCount] = {
+                chunk,
+                {
+                    &sliceParameters[sliceCount],
+                    &modulationMatrix,
+                    lfo1Buffer.data() + offset,
+                    lfo2Buffer.data() + offset,
+                    keepRamp (ParameterId::oscillatorPdAmount, pdAmountRampBuffer),
+                    keepRamp (ParameterId::filterCutoffHz, cutoffRampBuffer),
+                },
+            };
+
+            offset += chunk;
         }
 
-        if (filterPosition == FilterPosition::preOscMix)
-            oscillatorSample = filter.processSample (oscillatorSample, lastKeyFrequencyHz);
+        mixBus.clear (segment);
+        endStage (telemetry::Stage::modulation);
 
-        const auto mixed = oscillatorSample * oscillatorMixGain;
+        voiceManager.render (mixBus.getLeft(), mixBus.getRight(), std::span (renderSlices.data(), sliceCount));
+        endStage (telemetry::Stage::voices);
 
-        float filtered = mixed;
-        if (filterPosition == FilterPosition::postOscMix)
-            filtered = filter.processSample (mixed, lastKeyFrequencyHz);
+        std::array<float*, 2> channels {};
+        for (int channel = 0; channel < numChannels; ++channel)
+            channels[static_cast<std::size_t> (channel)] = buffer.getWritePointer (channel, startSample);
 
-        const auto amped = filtered * juce::jlimit (0.0f, 1.0f, ampMod);
-        const auto value = (activeVoices > 0 ? softLimit (amped) : 0.0f);
+        // Without a gain ramp in any sub-block the gain held still for the whole segment.
+        if (gainRamping)
+        {
+            mixBus.applyGainRamp (gainRampBuffer.data(), segment);
+            mixBus.renderTo (channels.data(), numChannels, segment, 1.0f);
+        }
+        else
+        {
+            mixBus.renderTo (channels.data(), numChannels, segment, oscillatorMixGain);
+        }
 
-        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
-            buffer.setSample (channel, sample, value);
+        endStage (telemetry::Stage::output);
 
-        uiPdAmountMod.store (pdAmountMod, std::memory_order_relaxed);
-        uiFilterCutoffMod.store (cutoffMod, std::memory_order_relaxed);
-        uiAmpMod.store (ampMod, std::memory_order_relaxed);
+        startSample += segment;
+        numSamples -= segment;
     }
 }
 
-SecretSynthAudioProcessor::UiModulationState SecretSynthAudioProcessor::getUiModulationState() const noexcept
+SecretSynthAudioProcessor::UiModulationState SecretSynthAudioProcessor::getUiModulationState() noexcept
+{
+    const auto& frame = getLatestTelemetry();
+    return { frame.pdAmountModulation, frame.filterCutoffModulation, frame.ampModulation };
+}
+
+const telemetry::TelemetryFrame& SecretSynthAudioProcessor::getLatestTelemetry() noexcept
+{
+    telemetryFifo.popLatest (latestTelemetry);
+    return latestTelemetry;
+}
+
+bool SecretSynthAudioProcessor::loadScalaTuning (const juce::File& scaleFile, const juce::File& keyboardMappingFile)
 {
-    return { uiPdAmountMod.load (std::memory_order_relaxed),
-             uiFilterCutoffMod.load (std::memory_order_relaxed),
-             uiAmpMod.load (std::memory_order_relaxed) };
+    if (! scaleFile.existsAsFile())
+        return false;
+
+    const auto scaleText = scaleFile.loadFileAsString().toStdString();
+    const auto mappingText = keyboardMappingFile.existsAsFile() ? keyboardMappingFile.loadFileAsString().toStdString() : std::string {};
+
+    secretsynth::dsp::tuning::TuningTable table;
+    if (! table.loadScala (scaleText, mappingText))
+        return false;
+
+    tuning.publish (table);
+    return true;
 }
 
 juce::AudioProcessorEditor* SecretSynthAudioProcessor::createEditor()
@@ -225,7 +547,9 @@ bool SecretSynthAudioProcessor::isMidiEffect() const
 
 double SecretSynthAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    // Released voices sound for the amp release time, so the host can stop calling processBlock
+    // this long after the last note-off.
+    return static_cast<double> (getParameterValue (parameters::ParameterId::ampReleaseSeconds)) + tailMarginSeconds;
 }
 
 int SecretSynthAudioProcessor::getNumPrograms()
@@ -249,6 +573,8 @@ void SecretSynthAudioProcessor::changeProgramName (int, const juce::String&) {}
 
 void SecretSynthAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
+    SECRETSYNTH_TRACE_SCOPE ("getStateInformation");
+
     for (const auto& spec : parameters::parameterSpecs)
     {
         pluginState.values[static_cast<std::size_t> (spec.id)] = getParameterValue (spec.id);
@@ -256,27 +582,27 @@ void SecretSynthAudioProcessor::getStateInformation (juce::MemoryBlock& destData
 
     juce::MemoryOutputStream stream (destData, true);
     stream.writeString (parameters::serializeState (pluginState));
-    stream.writeString (modulationMatrix.serialize());
+
+    const auto routeData = routeState.serialize();
+    stream.write (routeData.data(), routeData.size());
 }
 
 void SecretSynthAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    const auto stateText = juce::String::fromUTF8 (static_cast<const char*> (data), sizeInBytes);
-    const auto lines = juce::StringArray::fromLines (stateText);
+    SECRETSYNTH_TRACE_SCOPE ("setStateInformation");
 
-    juce::String parameterStateText;
-    juce::String modulationText;
+    // Layout: null-terminated parameter text, then either the binary route block or, for
+    // sessions saved before it existed, the null-terminated route debug text.
+    const auto* bytes = static_cast<const std::uint8_t*> (data);
+    const auto* bytesEnd = bytes + juce::jmax (0, sizeInBytes);
+    const auto* parameterTextEnd = std::find (bytes, bytesEnd, std::uint8_t { 0 });
 
-    for (const auto& line : lines)
-    {
-        if (line.startsWith ("state.version=") || line.startsWith ("osc.") || line.startsWith ("filter.") || line.startsWith ("output.") || line.startsWith ("mod.") || line.startsWith ("amp.") || line.startsWith ("performance."))
-            parameterStateText << line << "\n";
+    const std::string_view parameterStateText (reinterpret_cast<const char*> (bytes),
+                                               static_cast<std::size_t> (parameterTextEnd - bytes));
 
-        if (line.startsWith ("schema=") || line.startsWith ("routes=") || line.containsChar (','))
-            modulationText << line << "\n";
-    }
+    const std::span<const std::uint8_t> routeData (parameterTextEnd == bytesEnd ? bytesEnd : parameterTextEnd + 1, bytesEnd);
 
-    pluginState = parameters::deserializeState (parameterStateText.toStdString());
+    pluginState = parameters::deserializeState (parameterStateText);
 
     for (const auto& spec : parameters::parameterSpecs)
     {
@@ -285,10 +611,22 @@ void SecretSynthAudioProcessor::setStateInformation (const void* data, int sizeI
             valueTreeState.getParameterRange (juce::String (spec.stableId.data())).convertTo0to1 (value));
     }
 
-    applyStateToEngine();
+    // The audio thread picks the new values up at its next block.
+    parameterChanges.markAllChanged();
+
+    // Routes are parsed here and handed over whole; the audio thread never sees a half-loaded set.
+    if (secretsynth::dsp::mod::ModulationMatrix::isBinaryRouteData (routeData))
+    {
+        routeState.deserialize (routeData);
+    }
+    else if (! routeData.empty())
+    {
+        const auto routeTextEnd = std::find (routeData.begin(), routeData.end(), std::uint8_t { 0 });
+        routeState.fromDebugText ({ reinterpret_cast<const char*> (routeData.data()),
+                                    static_cast<std::size_t> (routeTextEnd - routeData.begin()) });
+    }
 
-    if (! modulationText.isEmpty())
-        modulationMatrix.deserialize (modulationText.toStdString());
+    sharedRoutes.publish (routeState.getRouteSet());
 }
 } // namespace secretsynth::plugin
 
@@ -1,16 +1,24 @@
 #pragma once
 
+#include <array>
 #include <atomic>
+#include <memory>
+#include <vector>
 
 #include <juce_audio_processors/juce_audio_processors.h>
-#include "../dsp/filter/MultiModeFilter.h"
+#include "../dsp/mix/StereoMixBus.h"
 #include "../dsp/mod/Modulation.h"
-#include "../dsp/osc/PhaseWarpOscillator.h"
+#include "../dsp/tuning/TuningTable.h"
+#include "../dsp/voice/VoiceManager.h"
+#include "parameters/ParameterChangeTracker.h"
+#include "parameters/SmoothedParameters.h"
 #include "parameters/StateSerialization.h"
+#include "telemetry/TelemetryFifo.h"
 
 namespace secretsynth::plugin
 {
-class SecretSynthAudioProcessor : public juce::AudioProcessor
+class SecretSynthAudioProcessor : public juce::AudioProcessor,
+                                  private juce::AudioProcessorValueTreeState::Listener
 {
 public:
     struct UiModulationState
@@ -21,7 +29,7 @@ public:
     };
 
     SecretSynthAudioProcessor();
-    ~SecretSynthAudioProcessor() override = default;
+    ~SecretSynthAudioProcessor() override;
 
     void prepareToPlay (double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
@@ -49,35 +57,65 @@ public:
     void setStateInformation (const void* data, int sizeInBytes) override;
 
     juce::AudioProcessorValueTreeState& getValueTreeState() noexcept { return valueTreeState; }
-    UiModulationState getUiModulationState() const noexcept;
+    // Message thread. Both drain the telemetry the audio thread published since the last call and
+    // return the newest block's values.
+    UiModulationState getUiModulationState() noexcept;
+    const telemetry::TelemetryFrame& getLatestTelemetry() noexcept;
 
-private:
-    enum class FilterPosition
-    {
-        preOscMix,
-        postOscMix
-    };
+    // Any thread. Load histogram and per-stage totals since prepareToPlay or resetCpuLoad.
+    telemetry::CpuLoadMeter::Snapshot getCpuLoadSnapshot() const noexcept { return cpuLoadMeter.getSnapshot(); }
+    void resetCpuLoad() noexcept { cpuLoadMeter.reset(); }
 
-    static float softLimit (float sample) noexcept;
+    // Message thread. Parses a Scala scale and optional keyboard mapping and hands the resulting
+    // table to the audio thread; returns false and keeps the current tuning if a file is malformed.
+    bool loadScalaTuning (const juce::File& scaleFile, const juce::File& keyboardMappingFile = {});
+
+private:
+    void parameterChanged (const juce::String& parameterID, float newValue) override;
     void applyStateToEngine();
+    void advanceSmoothedParameters (int numSamples);
+    void bumpParameterRevision() noexcept;
+    void handleMidiMessage (const juce::MidiMessage& message);
+    void renderVoices (juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+    void skipSilentBlock (juce::AudioBuffer<float>& buffer);
+    void endStage (telemetry::Stage stage) noexcept;
+    void publishTelemetry (const juce::AudioBuffer<float>& buffer, double renderSeconds) noexcept;
+    void publishTelemetry (int numSamples, float peakLeft, float peakRight, double renderSeconds) noexcept;
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
     float getParameterValue (parameters::ParameterId id) const noexcept;
 
-    secretsynth::dsp::osc::PhaseWarpOscillator oscillator;
-    secretsynth::dsp::filter::MultiModeFilter filter;
+    std::unique_ptr<secretsynth::dsp::voice::RenderThreadPool> renderThreadPool;
+    secretsynth::dsp::voice::VoiceManager voiceManager;
+    secretsynth::dsp::tuning::SharedTuningTable tuning;
+    secretsynth::dsp::voice::Voice::RenderParameters voiceParameters;
     secretsynth::dsp::mod::ModulationMatrix modulationMatrix;
+    secretsynth::dsp::mod::ModulationMatrix routeState; // message thread: the routes sessions save and load
+    secretsynth::dsp::mod::SharedRouteSet sharedRoutes;
+    const secretsynth::dsp::mod::RouteSet* appliedRoutes { nullptr };
     secretsynth::dsp::mod::ModulationEngine modulationEngine;
 
-    FilterPosition filterPosition { FilterPosition::postOscMix };
+    // Per-segment control data: each sub-block's parameters and ramps, handed to the voices at once.
+    std::vector<float> lfo1Buffer;
+    std::vector<float> lfo2Buffer;
+    std::vector<float> pdAmountRampBuffer;
+    std::vector<float> cutoffRampBuffer;
+    std::vector<float> gainRampBuffer;
+    std::vector<secretsynth::dsp::voice::Voice::RenderParameters> sliceParameters;
+    std::vector<secretsynth::dsp::voice::VoiceManager::RenderSlice> renderSlices;
+    secretsynth::dsp::mix::StereoMixBus mixBus;
+
     float oscillatorMixGain { 1.0f };
-    int activeVoices { 0 };
-    float lastKeyFrequencyHz { 220.0f };
     parameters::PluginState pluginState { parameters::makeDefaultState() };
+    parameters::ParameterChangeTracker parameterChanges;
+    parameters::SmoothedParameters smoothedParameters;
     juce::AudioProcessorValueTreeState valueTreeState;
+    std::array<std::atomic<float>*, parameters::parameterCount> rawParameterValues {};
 
-    std::atomic<float> uiPdAmountMod { 0.0f };
-    std::atomic<float> uiFilterCutoffMod { 0.0f };
-    std::atomic<float> uiAmpMod { 0.0f };
+    telemetry::CpuLoadMeter cpuLoadMeter;
+    std::array<juce::int64, telemetry::stageCount> stageTicks {};
+    juce::int64 stageStartTicks { 0 };
+    telemetry::TelemetryFifo telemetryFifo;
+    telemetry::TelemetryFrame latestTelemetry; // message thread
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SecretSynthAudioProcessor)
 };
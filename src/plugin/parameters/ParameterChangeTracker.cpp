@@ -0,0 +1,59 @@
+#include "ParameterChangeTracker.h"
+
+namespace secretsynth::plugin::parameters
+{
+namespace
+{
+constexpr std::uint64_t bitFor (ParameterId id) noexcept
+{
+    return std::uint64_t { 1 } << (static_cast<std::size_t> (id) % 64);
+}
+
+constexpr std::size_t wordFor (ParameterId id) noexcept
+{
+    return static_cast<std::size_t> (id) / 64;
+}
+} // namespace
+
+bool ParameterChangeTracker::ChangeSet::contains (ParameterId id) const noexcept
+{
+    return (words[wordFor (id)] & bitFor (id)) != 0;
+}
+
+bool ParameterChangeTracker::ChangeSet::any() const noexcept
+{
+    for (const auto word : words)
+    {
+        if (word != 0)
+            return true;
+    }
+
+    return false;
+}
+
+ParameterChangeTracker::ParameterChangeTracker() noexcept
+{
+    markAllChanged();
+}
+
+void ParameterChangeTracker::markChanged (ParameterId id) noexcept
+{
+    // Release pairs with takeChanges, so the new parameter value is visible once the bit is.
+    words[wordFor (id)].fetch_or (bitFor (id), std::memory_order_release);
+}
+
+void ParameterChangeTracker::markAllChanged() noexcept
+{
+    for (const auto& spec : parameterSpecs)
+        markChanged (spec.id);
+}
+
+ParameterChangeTracker::ChangeSet ParameterChangeTracker::takeChanges() noexcept
+{
+    ChangeSet changes;
+    for (std::size_t word = 0; word < wordCount; ++word)
+        changes.words[word] = words[word].exchange (0, std::memory_order_acquire);
+
+    return changes;
+}
+} // namespace secretsynth::plugin::parameters
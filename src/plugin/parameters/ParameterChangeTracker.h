@@ -0,0 +1,42 @@
+#pragma once
+
+#include "ParameterRegistry.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace secretsynth::plugin::parameters
+{
+// Lock-free set of parameters changed since the audio thread last looked. Listeners mark ids from
+// any thread; the audio thread takes the whole set once per block and applies only those ids.
+class ParameterChangeTracker
+{
+public:
+    static constexpr std::size_t wordCount = (parameterCount + 63) / 64;
+
+    class ChangeSet
+    {
+    public:
+        [[nodiscard]] bool contains (ParameterId id) const noexcept;
+        [[nodiscard]] bool any() const noexcept;
+
+    private:
+        friend class ParameterChangeTracker;
+        std::array<std::uint64_t, wordCount> words {};
+    };
+
+    // Starts with every parameter marked, so the first block applies the full state.
+    ParameterChangeTracker() noexcept;
+
+    void markChanged (ParameterId id) noexcept;
+    void markAllChanged() noexcept;
+
+    // Returns the marked ids and clears them.
+    [[nodiscard]] ChangeSet takeChanges() noexcept;
+
+private:
+    std::array<std::atomic<std::uint64_t>, wordCount> words {};
+};
+} // namespace secretsynth::plugin::parameters
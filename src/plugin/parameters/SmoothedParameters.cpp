@@ -0,0 +1,65 @@
+#include "SmoothedParameters.h"
+
+#include <algorithm>
+
+namespace secretsynth::plugin::parameters
+{
+void SmoothedParameters::prepare (double sampleRate, int maxBlockSize)
+{
+    blockCapacity = std::max (1, maxBlockSize);
+    buffers.assign (parameterCount * static_cast<std::size_t> (blockCapacity), 0.0f);
+
+    for (const auto& spec : parameterSpecs)
+    {
+        auto& ramp = ramps[static_cast<std::size_t> (spec.id)];
+        ramp.setSampleRate (sampleRate);
+        ramp.reset (spec.defaultValue);
+    }
+
+    rampedThisBlock.fill (false);
+}
+
+void SmoothedParameters::setRampTimeSeconds (ParameterId id, float seconds) noexcept
+{
+    ramps[static_cast<std::size_t> (id)].setRampTimeSeconds (seconds);
+}
+
+void SmoothedParameters::setTargetValue (ParameterId id, float value) noexcept
+{
+    ramps[static_cast<std::size_t> (id)].setTargetValue (value);
+}
+
+void SmoothedParameters::finishRamps() noexcept
+{
+    for (auto& ramp : ramps)
+        ramp.reset (ramp.getTargetValue());
+
+    rampedThisBlock.fill (false);
+}
+
+void SmoothedParameters::process (int numSamples) noexcept
+{
+    numSamples = std::clamp (numSamples, 0, blockCapacity);
+    for (std::size_t index = 0; index < parameterCount; ++index)
+    {
+        auto* buffer = buffers.data() + index * static_cast<std::size_t> (blockCapacity);
+        rampedThisBlock[index] = ! buffers.empty() && ramps[index].process (buffer, numSamples);
+    }
+}
+
+const float* SmoothedParameters::getRamp (ParameterId id) const noexcept
+{
+    const auto index = static_cast<std::size_t> (id);
+    return rampedThisBlock[index] ? buffers.data() + index * static_cast<std::size_t> (blockCapacity) : nullptr;
+}
+
+float SmoothedParameters::getValue (ParameterId id) const noexcept
+{
+    return ramps[static_cast<std::size_t> (id)].getCurrentValue();
+}
+
+bool SmoothedParameters::isRamping (ParameterId id) const noexcept
+{
+    return ramps[static_cast<std::size_t> (id)].isRamping();
+}
+} // namespace secretsynth::plugin::parameters
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "ParameterRegistry.h"
+#include "../../dsp/mod/Modulation.h"
+
+#include <array>
+#include <vector>
+
+namespace secretsynth::plugin::parameters
+{
+// One linear ramp per parameter. The audio thread sets targets as values change and calls process
+// once per render block; a parameter that is still moving exposes that block's per-sample values
+// through getRamp, and a settled one returns nullptr so consumers use getValue as a constant.
+class SmoothedParameters
+{
+public:
+    // Allocates the ramp buffers and snaps every parameter to its default value.
+    void prepare (double sampleRate, int maxBlockSize);
+
+    // 0 (the default) makes the parameter step to new targets.
+    void setRampTimeSeconds (ParameterId id, float seconds) noexcept;
+    void setTargetValue (ParameterId id, float value) noexcept;
+
+    // Jumps every parameter to its target, e.g. after loading state before playback starts.
+    void finishRamps() noexcept;
+
+    // numSamples is clamped to the prepared block size.
+    void process (int numSamples) noexcept;
+
+    [[nodiscard]] const float* getRamp (ParameterId id) const noexcept;
+    [[nodiscard]] float getValue (ParameterId id) const noexcept;
+    [[nodiscard]] bool isRamping (ParameterId id) const noexcept;
+
+private:
+    std::array<dsp::mod::LinearRamp, parameterCount> ramps {};
+    std::array<bool, parameterCount> rampedThisBlock {};
+    std::vector<float> buffers;
+    int blockCapacity { 0 };
+};
+} // namespace secretsynth::plugin::parameters
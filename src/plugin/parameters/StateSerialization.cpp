@@ -1,5 +1,7 @@
 #include "StateSerialization.h"
 
+#include "../../dsp/trace/Trace.h"
+
 #include <algorithm>
 #include <charconv>
 #include <sstream>
@@ -57,6 +59,8 @@ float clampToRange (ParameterId id, float value) noexcept
 
 std::string serializeState (const PluginState& state)
 {
+    SECRETSYNTH_TRACE_SCOPE ("serializeState");
+
     std::ostringstream stream;
     stream << "state.version=" << currentStateVersion << "\n";
 
@@ -71,6 +75,8 @@ std::string serializeState (const PluginState& state)
 
 PluginState deserializeState (std::string_view serialized)
 {
+    SECRETSYNTH_TRACE_SCOPE ("deserializeState");
+
     PluginState parsedState = makeDefaultState();
     int stateVersion = 0;
 
@@ -0,0 +1,101 @@
+#include "CpuLoadMeter.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace secretsynth::plugin::telemetry
+{
+float CpuLoadMeter::Snapshot::getAverageLoad() const noexcept
+{
+    return budgetSeconds > 0.0 ? static_cast<float> (renderSeconds / budgetSeconds) : 0.0f;
+}
+
+float CpuLoadMeter::Snapshot::getLoadPercentile (double fraction) const noexcept
+{
+    if (blocks == 0)
+        return 0.0f;
+
+    const auto target = static_cast<std::uint64_t> (std::ceil (std::clamp (fraction, 0.0, 1.0) * static_cast<double> (blocks)));
+    std::uint64_t counted = 0;
+    for (std::size_t bin = 0; bin < binCount; ++bin)
+    {
+        counted += histogram[bin];
+        if (counted >= std::max<std::uint64_t> (target, 1))
+            return static_cast<float> (bin + 1) * binWidth;
+    }
+
+    return static_cast<float> (binCount) * binWidth;
+}
+
+void CpuLoadMeter::setSampleRate (double newSampleRate) noexcept
+{
+    if (newSampleRate > 0.0)
+        sampleRate.store (newSampleRate, std::memory_order_relaxed);
+}
+
+float CpuLoadMeter::recordBlock (int numSamples, double blockRenderSeconds, const StageSeconds& blockStageSeconds) noexcept
+{
+    if (numSamples <= 0)
+        return 0.0f;
+
+    const auto budget = static_cast<double> (numSamples) / sampleRate.load (std::memory_order_relaxed);
+    const auto load = static_cast<float> (blockRenderSeconds / budget);
+
+    // Read-modify-writes rather than load/store pairs, so a reset() from another thread is never undone.
+    histogram[binForLoad (load)].fetch_add (1, std::memory_order_relaxed);
+    for (std::size_t stage = 0; stage < stageCount; ++stage)
+        stageSeconds[stage].fetch_add (blockStageSeconds[stage], std::memory_order_relaxed);
+
+    blocks.fetch_add (1, std::memory_order_relaxed);
+    renderSeconds.fetch_add (blockRenderSeconds, std::memory_order_relaxed);
+    budgetSeconds.fetch_add (budget, std::memory_order_relaxed);
+    lastLoad.store (load, std::memory_order_relaxed);
+
+    auto peak = peakLoad.load (std::memory_order_relaxed);
+    while (load > peak && ! peakLoad.compare_exchange_weak (peak, load, std::memory_order_relaxed))
+    {
+    }
+
+    return load;
+}
+
+CpuLoadMeter::Snapshot CpuLoadMeter::getSnapshot() const noexcept
+{
+    Snapshot snapshot;
+    for (std::size_t bin = 0; bin < binCount; ++bin)
+        snapshot.histogram[bin] = histogram[bin].load (std::memory_order_relaxed);
+
+    for (std::size_t stage = 0; stage < stageCount; ++stage)
+        snapshot.stageSeconds[stage] = stageSeconds[stage].load (std::memory_order_relaxed);
+
+    snapshot.blocks = blocks.load (std::memory_order_relaxed);
+    snapshot.renderSeconds = renderSeconds.load (std::memory_order_relaxed);
+    snapshot.budgetSeconds = budgetSeconds.load (std::memory_order_relaxed);
+    snapshot.lastLoad = lastLoad.load (std::memory_order_relaxed);
+    snapshot.peakLoad = peakLoad.load (std::memory_order_relaxed);
+    return snapshot;
+}
+
+void CpuLoadMeter::reset() noexcept
+{
+    for (auto& bin : histogram)
+        bin.store (0, std::memory_order_relaxed);
+
+    for (auto& stage : stageSeconds)
+        stage.store (0.0, std::memory_order_relaxed);
+
+    blocks.store (0, std::memory_order_relaxed);
+    renderSeconds.store (0.0, std::memory_order_relaxed);
+    budgetSeconds.store (0.0, std::memory_order_relaxed);
+    lastLoad.store (0.0f, std::memory_order_relaxed);
+    peakLoad.store (0.0f, std::memory_order_relaxed);
+}
+
+std::size_t CpuLoadMeter::binForLoad (float load) noexcept
+{
+    if (! (load > 0.0f))
+        return 0;
+
+    return std::min (binCount - 1, static_cast<std::size_t> (load / binWidth));
+}
+} // namespace secretsynth::plugin::telemetry
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace secretsynth::plugin::telemetry
+{
+// Parts of processBlock timed separately. Voices covers note handling, oscillators, envelopes and
+// filters; output covers gain and the output stage.
+enum class Stage
+{
+    modulation,
+    voices,
+    output,
+    count
+};
+
+inline constexpr std::size_t stageCount = static_cast<std::size_t> (Stage::count);
+
+using StageSeconds = std::array<double, stageCount>;
+
+// Audio-thread load: each block's processing time over its real-time budget (numSamples /
+// sampleRate), where 1 means the block took as long as it lasts. The audio thread records and any
+// thread reads; neither side locks.
+class CpuLoadMeter
+{
+public:
+    static constexpr float binWidth = 0.05f;
+    static constexpr std::size_t binCount = 41; // the last bin holds every block at or above 200 %
+
+    struct Snapshot
+    {
+        std::array<std::uint64_t, binCount> histogram {};
+        StageSeconds stageSeconds {}; // totals since the last reset
+        std::uint64_t blocks { 0 };
+        double renderSeconds { 0.0 };
+        double budgetSeconds { 0.0 };
+        float lastLoad { 0.0f };
+        float peakLoad { 0.0f };
+
+        [[nodiscard]] float getAverageLoad() const noexcept;
+
+        // Upper edge of the histogram bin holding the given fraction of blocks, e.g. 0.99 for p99.
+        [[nodiscard]] float getLoadPercentile (double fraction) const noexcept;
+    };
+
+    void setSampleRate (double newSampleRate) noexcept;
+
+    // Audio thread, once per block. Returns the block's load.
+    float recordBlock (int numSamples, double renderSeconds, const StageSeconds& stageSeconds) noexcept;
+
+    // Any thread. Counts from a block recorded at the same time may be split across snapshots.
+    [[nodiscard]] Snapshot getSnapshot() const noexcept;
+    void reset() noexcept;
+
+    [[nodiscard]] static std::size_t binForLoad (float load) noexcept;
+
+private:
+    static_assert (std::atomic<double>::is_always_lock_free && std::atomic<std::uint64_t>::is_always_lock_free);
+
+    std::atomic<double> sampleRate { 44100.0 };
+    std::array<std::atomic<std::uint64_t>, binCount> histogram {};
+    std::array<std::atomic<double>, stageCount> stageSeconds {};
+    std::atomic<std::uint64_t> blocks { 0 };
+    std::atomic<double> renderSeconds { 0.0 };
+    std::atomic<double> budgetSeconds { 0.0 };
+    std::atomic<float> lastLoad { 0.0f };
+    std::atomic<float> peakLoad { 0.0f };
+};
+} // namespace secretsynth::plugin::telemetry
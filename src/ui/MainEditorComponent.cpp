@@ -4,6 +4,7 @@
 
 #include <array>
 #include <cmath>
+#include <cstdint>
 
 namespace secretsynth::ui
 {
@@ -117,6 +118,71 @@ private:
     juce::Slider& shapeSlider;
 };
 
+// Audio-thread load: the latest block, the peak, the p99 of the histogram and each stage's share
+// of the render time, so heavy presets and voice counts show up without a profiler.
+class LoadMeter final : public juce::Component
+{
+public:
+    using CpuLoadMeter = plugin::telemetry::CpuLoadMeter;
+
+    void update (const plugin::telemetry::TelemetryFrame& frame, const CpuLoadMeter::Snapshot& newSnapshot)
+    {
+        latest = frame;
+        snapshot = newSnapshot;
+        repaint();
+    }
+
+    void paint (juce::Graphics& g) override
+    {
+        g.fillAll (juce::Colour::fromRGB (14, 19, 28));
+        g.setColour (juce::Colours::white.withAlpha (0.1f));
+        g.drawRect (getLocalBounds());
+
+        auto bounds = getLocalBounds().toFloat().reduced (8.0f);
+        const auto percent = [] (float load) { return juce::String (juce::roundToInt (load * 100.0f)) + "%"; };
+
+        g.setColour (juce::Colours::white.withAlpha (0.8f));
+        g.setFont (juce::FontOptions (12.0f));
+        g.drawText ("CPU " + percent (latest.load) + "   peak " + percent (snapshot.peakLoad) + "   p99 " + percent (snapshot.getLoadPercentile (0.99))
+                        + "   voices " + juce::String (latest.activeVoices),
+                    bounds.removeFromTop (18.0f),
+                    juce::Justification::left);
+
+        constexpr std::array<const char*, plugin::telemetry::stageCount> stageNames { "mod", "voices", "output" };
+        juce::String stages;
+        for (std::size_t stage = 0; stage < stageNames.size(); ++stage)
+        {
+            const auto share = snapshot.renderSeconds > 0.0 ? snapshot.stageSeconds[stage] / snapshot.renderSeconds : 0.0;
+            stages << stageNames[stage] << " " << percent (static_cast<float> (share)) << "   ";
+        }
+
+        g.drawText (stages, bounds.removeFromTop (18.0f), juce::Justification::left);
+        bounds.removeFromTop (4.0f);
+
+        // Block-load histogram up to 200 %; bars right of the budget line are blocks that missed it.
+        std::uint64_t maxCount = 1;
+        for (const auto count : snapshot.histogram)
+            maxCount = juce::jmax (maxCount, count);
+
+        const auto barWidth = bounds.getWidth() / static_cast<float> (CpuLoadMeter::binCount);
+        for (std::size_t bin = 0; bin < CpuLoadMeter::binCount; ++bin)
+        {
+            const auto binLoad = static_cast<float> (bin) * CpuLoadMeter::binWidth;
+            const auto height = bounds.getHeight() * static_cast<float> (snapshot.histogram[bin]) / static_cast<float> (maxCount);
+            g.setColour (binLoad >= 1.0f ? juce::Colours::red : (binLoad >= 0.7f ? juce::Colours::orange : juce::Colours::deepskyblue));
+            g.fillRect (juce::Rectangle<float> (bounds.getX() + barWidth * static_cast<float> (bin), bounds.getBottom() - height, juce::jmax (1.0f, barWidth - 1.0f), height));
+        }
+
+        const auto budgetX = bounds.getX() + barWidth / CpuLoadMeter::binWidth;
+        g.setColour (juce::Colours::white.withAlpha (0.5f));
+        g.drawVerticalLine (static_cast<int> (budgetX), bounds.getY(), bounds.getBottom());
+    }
+
+private:
+    plugin::telemetry::TelemetryFrame latest;
+    CpuLoadMeter::Snapshot snapshot;
+};
+
 class Section final : public juce::Component
 {
 public:
@@ -250,6 +316,7 @@ public:
         owner.addAndMakeVisible (ampSection);
         owner.addAndMakeVisible (perfSection);
         owner.addAndMakeVisible (pdVisualizer);
+        owner.addAndMakeVisible (loadMeter);
 
         startTimerHz (30);
     }
@@ -257,7 +324,10 @@ public:
     void resized()
     {
         auto area = owner.getLocalBounds().reduced (12);
-        pdVisualizer.setBounds (area.removeFromTop (140));
+        auto header = area.removeFromTop (140);
+        loadMeter.setBounds (header.removeFromRight (juce::jmin (320, header.getWidth() / 3)));
+        header.removeFromRight (8);
+        pdVisualizer.setBounds (header);
         area.removeFromTop (8);
 
         juce::Grid grid;
@@ -287,6 +357,7 @@ private:
         oscPdAmount.repaint();
         filterCutoff.repaint();
         outputGain.repaint();
+        loadMeter.update (processor.getLatestTelemetry(), processor.getCpuLoadSnapshot());
     }
 
     static void configureSlider (juce::Slider& slider, bool integerStep = false)
@@ -330,6 +401,7 @@ private:
     ModulatedSlider performanceVoices;
 
     PdVisualizer pdVisualizer;
+    LoadMeter loadMeter;
 
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> oscFrequencyAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> oscPdAmountAttachment;
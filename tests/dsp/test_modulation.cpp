@@ -1,8 +1,14 @@
 #include <array>
+#include <atomic>
 #include <cmath>
+#include <cstdint>
 #include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "../../src/dsp/mod/Modulation.h"
+#include "../support/RealtimeChecker.h"
 
 namespace
 {
@@ -136,6 +142,325 @@ bool testSerializationRoundTrip()
 
     return true;
 }
+
+bool testDebugTextRoundTrip()
+{
+    ModulationMatrix matrix;
+    matrix.addRoute ({ Source::modEnv, Destination::pdAmount, -0.5f, true });
+    matrix.addRoute ({ Source::keyTrack, Destination::pitch, 0.125f, false });
+
+    ModulationMatrix restored;
+    if (! restored.fromDebugText (matrix.toDebugText()))
+    {
+        std::cerr << "Debug text round-trip failed.\n";
+        return false;
+    }
+
+    const auto& routes = restored.getRoutes();
+    if (routes.size() != 2 || routes[0].source != Source::modEnv || ! almostEqual (routes[0].depth, -0.5f, 1.0e-6f)
+        || routes[1].destination != Destination::pitch || routes[1].bipolar)
+    {
+        std::cerr << "Debug text route mismatch.\n";
+        return false;
+    }
+
+    // Sessions saved before the binary format used this exact text layout.
+    if (! restored.fromDebugText ("schema=1\nroutes=1\n2,1,0.25,1\n") || restored.getRoutes().size() != 1)
+    {
+        std::cerr << "Legacy text layout was not accepted.\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool testMalformedInputIsRejected()
+{
+    ModulationMatrix reference;
+    reference.addRoute ({ Source::lfo2, Destination::amp, 0.5f, true });
+    const auto valid = reference.serialize();
+
+    ModulationMatrix matrix;
+    matrix.addRoute ({ Source::velocity, Destination::filterCutoff, 0.3f, false });
+
+    std::vector<std::vector<std::uint8_t>> badBinary;
+    badBinary.push_back ({});
+    badBinary.emplace_back (valid.begin(), valid.end() - 1);
+    badBinary.push_back (valid);
+    badBinary.back()[0] = 'X';
+    badBinary.push_back (valid);
+    badBinary.back()[4] = 0x7f;
+    badBinary.push_back (valid);
+    badBinary.back()[ModulationMatrix::binaryHeaderSize] = static_cast<std::uint8_t> (Source::count);
+    badBinary.push_back (valid);
+    badBinary.back()[ModulationMatrix::binaryHeaderSize + 1] = 0xff;
+    badBinary.push_back (valid);
+    badBinary.back()[6] = 0x02;
+    badBinary.push_back (valid);
+    badBinary.back()[ModulationMatrix::binaryHeaderSize + 7] = 0x7f;
+    badBinary.back()[ModulationMatrix::binaryHeaderSize + 6] = 0xc0;
+
+    for (std::size_t i = 0; i < badBinary.size(); ++i)
+    {
+        if (matrix.deserialize (badBinary[i]))
+        {
+            std::cerr << "Malformed binary case " << i << " was accepted.\n";
+            return false;
+        }
+    }
+
+    const std::array<std::string, 9> badText {
+        "",
+        "schema=one\nroutes=1\n0,0,1,0\n",
+        "schema=2\nroutes=0\n",
+        "schema=1\nroutes=-4\n",
+        "schema=1\nroutes=1\n0,0,abc,0\n",
+        "schema=1\nroutes=1\n9,0,1,0\n",
+        "schema=1\nroutes=1\n0,-1,1,0\n",
+        "schema=1\nroutes=1\n0,0,1\n",
+        "schema=1\nroutes=2\n0,0,1,0\n",
+    };
+
+    for (std::size_t i = 0; i < badText.size(); ++i)
+    {
+        if (matrix.fromDebugText (badText[i]))
+        {
+            std::cerr << "Malformed text case " << i << " was accepted.\n";
+            return false;
+        }
+    }
+
+    const auto& routes = matrix.getRoutes();
+    if (routes.size() != 1 || routes[0].source != Source::velocity)
+    {
+        std::cerr << "Rejected input modified existing routes.\n";
+        return false;
+    }
+
+    return true;
+}
+bool testLinearRampSettlesExactly()
+{
+    secretsynth::dsp::mod::LinearRamp ramp;
+    ramp.setSampleRate (1000.0);
+    ramp.setRampTimeSeconds (0.1f); // 100 samples
+    ramp.reset (0.0f);
+
+    std::array<float, 64> block {};
+    if (ramp.process (block.data(), static_cast<int> (block.size())))
+    {
+        std::cerr << "Settled ramp produced a buffer\n";
+        return false;
+    }
+
+    ramp.setTargetValue (1.0f);
+    if (! ramp.process (block.data(), 64) || std::abs (block[49] - 0.5f) > 1.0e-5f || std::abs (block[63] - 0.64f) > 1.0e-5f)
+    {
+        std::cerr << "Ramp is not linear across its first block\n";
+        return false;
+    }
+
+    if (! ramp.process (block.data(), 64) || block[35] != 1.0f || block[63] != 1.0f || ramp.isRamping() || ramp.getCurrentValue() != 1.0f)
+    {
+        std::cerr << "Ramp did not land exactly on its target\n";
+        return false;
+    }
+
+    if (ramp.process (block.data(), 64))
+    {
+        std::cerr << "Ramp kept producing buffers after settling\n";
+        return false;
+    }
+
+    ramp.setRampTimeSeconds (0.0f);
+    ramp.setTargetValue (0.25f);
+    if (ramp.process (block.data(), 64) || ramp.getCurrentValue() != 0.25f)
+    {
+        std::cerr << "Zero ramp time did not step to the target\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool testControlRateAdvanceMatchesPerSample()
+{
+    secretsynth::dsp::mod::Lfo perSample;
+    secretsynth::dsp::mod::Lfo controlRate;
+    secretsynth::dsp::mod::AdsrEnvelope perSampleEnvelope;
+    secretsynth::dsp::mod::AdsrEnvelope controlRateEnvelope;
+    for (auto* envelope : { &perSampleEnvelope, &controlRateEnvelope })
+    {
+        envelope->setSampleRate (48000.0);
+        envelope->setParameters ({ 0.002f, 0.01f, 0.5f, 0.02f });
+        envelope->noteOn();
+    }
+
+    for (auto* lfo : { &perSample, &controlRate })
+    {
+        lfo->setSampleRate (48000.0);
+        lfo->setRateHz (7.0f);
+    }
+
+    for (int block = 0; block < 200; ++block)
+    {
+        if (block == 100)
+        {
+            perSampleEnvelope.noteOff();
+            controlRateEnvelope.noteOff();
+        }
+
+        for (int i = 0; i < 32; ++i)
+        {
+            perSample.processSample();
+            perSampleEnvelope.processSample();
+        }
+
+        if (std::abs (controlRate.advance (32) - perSample.getCurrentValue()) > 1.0e-3f
+            || controlRateEnvelope.advance (32) != perSampleEnvelope.getCurrentValue())
+        {
+            std::cerr << "Control-rate advance drifted from per-sample processing at block " << block << '\n';
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool testAudioThreadCallsAreRealtimeSafe()
+{
+    namespace realtime = secretsynth::test::realtime;
+
+    ModulationEngine engine;
+    engine.setSampleRate (48000.0);
+    ModulationMatrix matrix;
+    matrix.setSampleRate (48000.0);
+    LinearRamp ramp;
+    ramp.setSampleRate (48000.0);
+    ramp.setRampTimeSeconds (0.02f);
+    std::array<float, 64> rampBuffer {};
+
+    realtime::reset();
+
+    {
+        const realtime::ScopedAudioThread audioThread;
+
+        for (int block = 0; block < 100; ++block)
+        {
+            // Rebuilding routes up to the reserved capacity reuses the matrix's storage.
+            matrix.clearRoutes();
+            for (std::size_t route = 0; route < ModulationMatrix::routeCapacity; ++route)
+                matrix.addRoute ({ static_cast<Source> (route % static_cast<std::size_t> (Source::count)),
+                                   static_cast<Destination> (route % static_cast<std::size_t> (Destination::count)),
+                                   0.1f,
+                                   route % 2 == 0 });
+
+            if (block % 10 == 0)
+            {
+                engine.ampEnv.noteOn();
+                engine.modEnv.noteOn();
+            }
+            else if (block % 10 == 5)
+            {
+                engine.ampEnv.noteOff();
+                engine.modEnv.noteOff();
+            }
+
+            ramp.setTargetValue (static_cast<float> (block % 7));
+            ramp.process (rampBuffer.data(), static_cast<int> (rampBuffer.size()));
+
+            const std::array<float, static_cast<std::size_t> (Source::count)> sources {
+                engine.ampEnv.advance (64), engine.modEnv.advance (64), engine.lfo1.advance (64), engine.lfo2.advance (64), 0.8f, 0.5f,
+            };
+            static_cast<void> (matrix.process (sources));
+        }
+    }
+
+    return realtime::reportViolations ("Modulation audio-thread calls");
+}
+
+bool testSharedRoutesSwapWhileReading()
+{
+    namespace realtime = secretsynth::test::realtime;
+
+    SharedRouteSet shared;
+    if (shared.acquire().count != 0)
+    {
+        std::cerr << "Shared routes do not start empty\n";
+        return false;
+    }
+
+    // Every published set has count routes of depth count; a reader must never see two mixed.
+    std::atomic<bool> done { false };
+    std::atomic<bool> torn { false };
+    std::atomic<bool> safe { true };
+    std::thread reader ([&]
+    {
+        ModulationMatrix matrix;
+        realtime::reset();
+
+        {
+            const realtime::ScopedAudioThread audioThread;
+            while (! done.load())
+            {
+                matrix.setRoutes (shared.acquire());
+                for (const auto& route : matrix.getRoutes())
+                {
+                    if (route.depth != static_cast<float> (matrix.getRoutes().size()))
+                        torn.store (true);
+                }
+            }
+        }
+
+        safe.store (realtime::reportViolations ("Route hand-off"));
+    });
+
+    for (std::size_t count = 1; count < 2000; ++count)
+    {
+        ModulationMatrix source;
+        for (std::size_t route = 0; route < count % ModulationMatrix::routeCapacity + 1; ++route)
+            source.addRoute ({ Source::lfo1, Destination::pitch, static_cast<float> (count % ModulationMatrix::routeCapacity + 1), true });
+
+        shared.publish (source.getRouteSet());
+    }
+
+    done.store (true);
+    reader.join();
+
+    if (torn.load())
+    {
+        std::cerr << "Reader saw a partly published route set\n";
+        return false;
+    }
+
+    const auto& latest = shared.acquire();
+    if (latest.count != 1999 % ModulationMatrix::routeCapacity + 1)
+    {
+        std::cerr << "Latest published route set is not current\n";
+        return false;
+    }
+
+    return safe.load();
+}
+
+bool testRouteSetKeepsCapacity()
+{
+    ModulationMatrix source;
+    for (std::size_t route = 0; route < ModulationMatrix::routeCapacity + 8; ++route)
+        source.addRoute ({ Source::velocity, Destination::amp, static_cast<float> (route), false });
+
+    ModulationMatrix destination;
+    destination.setRoutes (source.getRouteSet());
+
+    const auto& routes = destination.getRoutes();
+    if (routes.size() != ModulationMatrix::routeCapacity || routes.back().depth != static_cast<float> (ModulationMatrix::routeCapacity - 1))
+    {
+        std::cerr << "Route set did not keep the first routeCapacity routes\n";
+        return false;
+    }
+
+    return true;
+}
 } // namespace
 
 int main()
@@ -152,6 +477,27 @@ int main()
     if (! testSerializationRoundTrip())
         return 1;
 
+    if (! testDebugTextRoundTrip())
+        return 1;
+
+    if (! testMalformedInputIsRejected())
+        return 1;
+
+    if (! testLinearRampSettlesExactly())
+        return 1;
+
+    if (! testControlRateAdvanceMatchesPerSample())
+        return 1;
+
+    if (! testAudioThreadCallsAreRealtimeSafe())
+        return 1;
+
+    if (! testSharedRoutesSwapWhileReading())
+        return 1;
+
+    if (! testRouteSetKeepsCapacity())
+        return 1;
+
     std::cout << "Modulation tests passed\n";
     return 0;
 }
@@ -0,0 +1,109 @@
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "../../src/dsp/mix/OutputStage.h"
+
+namespace
+{
+using secretsynth::dsp::mix::OutputStage;
+
+bool testSaturatorsAreBoundedMonotonicAndUnitSlope()
+{
+    for (const auto saturator : { OutputStage::Saturator::tanh, OutputStage::Saturator::pade, OutputStage::Saturator::cubic })
+    {
+        OutputStage stage;
+        stage.setSaturator (saturator);
+
+        std::vector<float> input;
+        for (int step = -2000; step <= 2000; ++step)
+            input.push_back (static_cast<float> (step) * 0.005f);
+
+        std::vector<float> output (input.size(), 0.0f);
+        stage.process (input.data(), output.data(), static_cast<int> (input.size()), 1.0f);
+
+        for (std::size_t i = 0; i < output.size(); ++i)
+        {
+            if (std::abs (output[i]) > 1.0f || (i > 0 && output[i] < output[i - 1]))
+            {
+                std::cerr << "Saturator " << static_cast<int> (saturator) << " is not bounded and monotonic at " << input[i] << '\n';
+                return false;
+            }
+        }
+
+        // Slope at the origin is one for every curve.
+        const auto centre = input.size() / 2;
+        const auto slope = (output[centre + 1] - output[centre - 1]) / (input[centre + 1] - input[centre - 1]);
+        if (std::abs (slope - 1.0f) > 1.0e-3f || std::abs (output.back() - 1.0f) > 1.0e-3f)
+        {
+            std::cerr << "Saturator " << static_cast<int> (saturator) << " lost unit slope or full-scale ceiling\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool testPadeTracksTanh()
+{
+    for (int step = -2000; step <= 2000; ++step)
+    {
+        const auto x = static_cast<float> (step) * 0.01f;
+        if (std::abs (OutputStage::saturatePade (x) - std::tanh (x)) > 2.0e-4f)
+        {
+            std::cerr << "Pade saturator diverged from tanh at " << x << '\n';
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool testQuietBlocksTakeTheLinearPath()
+{
+    OutputStage stage;
+    stage.setSaturator (OutputStage::Saturator::tanh);
+
+    std::vector<float> quiet (128, 0.0f);
+    for (std::size_t i = 0; i < quiet.size(); ++i)
+        quiet[i] = 0.008f * std::sin (static_cast<float> (i) * 0.1f);
+
+    std::vector<float> output (quiet.size(), 0.0f);
+    stage.process (quiet.data(), output.data(), static_cast<int> (quiet.size()), 2.0f);
+
+    for (std::size_t i = 0; i < quiet.size(); ++i)
+    {
+        if (output[i] != quiet[i] * 2.0f)
+        {
+            std::cerr << "Quiet block was not passed through linearly\n";
+            return false;
+        }
+    }
+
+    // Processing in place over a loud block saturates.
+    std::vector<float> loud (64, 3.0f);
+    stage.process (loud.data(), loud.data(), static_cast<int> (loud.size()), 1.0f);
+    if (std::abs (loud[0] - std::tanh (3.0f)) > 1.0e-6f)
+    {
+        std::cerr << "Loud block skipped saturation\n";
+        return false;
+    }
+
+    return true;
+}
+} // namespace
+
+int main()
+{
+    if (! testSaturatorsAreBoundedMonotonicAndUnitSlope())
+        return 1;
+
+    if (! testPadeTracksTanh())
+        return 1;
+
+    if (! testQuietBlocksTakeTheLinearPath())
+        return 1;
+
+    std::cout << "OutputStage tests passed\n";
+    return 0;
+}
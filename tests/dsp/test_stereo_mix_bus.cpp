@@ -0,0 +1,94 @@
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "../../src/dsp/mix/StereoMixBus.h"
+
+namespace
+{
+using secretsynth::dsp::mix::StereoMixBus;
+
+bool testPanLawKeepsConstantPower()
+{
+    for (int step = -10; step <= 10; ++step)
+    {
+        const auto pan = static_cast<float> (step) / 10.0f;
+        const auto gains = StereoMixBus::constantPowerPan (pan);
+        const auto power = gains.left * gains.left + gains.right * gains.right;
+
+        if (std::abs (power - 1.0f) > 1.0e-5f || gains.left < 0.0f || gains.right < 0.0f)
+        {
+            std::cerr << "Pan " << pan << " broke the constant-power law\n";
+            return false;
+        }
+    }
+
+    const auto hardLeft = StereoMixBus::constantPowerPan (-1.0f);
+    const auto hardRight = StereoMixBus::constantPowerPan (1.0f);
+    if (hardLeft.right > 1.0e-6f || hardRight.left > 1.0e-6f)
+    {
+        std::cerr << "Hard pans leaked into the opposite channel\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool testRenderToFoldsMonoAndClearsExtraChannels()
+{
+    StereoMixBus bus;
+    bus.prepare (64);
+    bus.clear (64);
+
+    for (int sample = 0; sample < 64; ++sample)
+    {
+        bus.getLeft()[sample] = 0.1f;
+        bus.getRight()[sample] = 0.1f;
+    }
+
+    std::vector<float> left (64, 1.0f);
+    std::vector<float> right (64, 1.0f);
+    std::vector<float> extra (64, 1.0f);
+    const std::array<float*, 3> channels { left.data(), right.data(), extra.data() };
+    bus.renderTo (channels.data(), 3, 64, 2.0f);
+
+    if (std::abs (left[10] - std::tanh (0.2f)) > 2.0e-4f || left != right || extra[0] != 0.0f || extra[63] != 0.0f)
+    {
+        std::cerr << "Stereo render wrote unexpected channel data\n";
+        return false;
+    }
+
+    // Mono folds L + R at -3 dB, so a centred constant-power source keeps its level.
+    const auto centre = StereoMixBus::constantPowerPan (0.0f);
+    for (int sample = 0; sample < 64; ++sample)
+    {
+        bus.getLeft()[sample] = 0.5f * centre.left;
+        bus.getRight()[sample] = 0.5f * centre.right;
+    }
+
+    std::vector<float> mono (64, 0.0f);
+    float* monoChannel = mono.data();
+    bus.renderTo (&monoChannel, 1, 64, 1.0f);
+
+    if (std::abs (mono[0] - std::tanh (0.5f)) > 2.0e-4f)
+    {
+        std::cerr << "Mono fold changed the level of a centred source\n";
+        return false;
+    }
+
+    return true;
+}
+} // namespace
+
+int main()
+{
+    if (! testPanLawKeepsConstantPower())
+        return 1;
+
+    if (! testRenderToFoldsMonoAndClearsExtraChannels())
+        return 1;
+
+    std::cout << "StereoMixBus tests passed\n";
+    return 0;
+}
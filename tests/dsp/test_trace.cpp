@@ -0,0 +1,92 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "../../src/dsp/trace/Trace.h"
+
+namespace
+{
+namespace trace = secretsynth::dsp::trace;
+
+std::size_t countOccurrences (const std::string& text, const std::string& pattern)
+{
+    std::size_t count = 0;
+    for (auto position = text.find (pattern); position != std::string::npos; position = text.find (pattern, position + 1))
+        ++count;
+
+    return count;
+}
+
+bool testScopesBecomeChromeTraceEvents()
+{
+    {
+        SECRETSYNTH_TRACE_SCOPE ("outer");
+        for (int i = 0; i < 3; ++i)
+        {
+            SECRETSYNTH_TRACE_SCOPE ("inner");
+        }
+    }
+
+    std::thread worker ([]
+    {
+        SECRETSYNTH_TRACE_SCOPE ("worker \"quoted\"");
+    });
+    worker.join();
+
+    std::ostringstream output;
+    trace::writeChromeTrace (output);
+    const auto json = output.str();
+
+    if (json.rfind ("{\"traceEvents\":[", 0) != 0 || json.find ("\"displayTimeUnit\":\"ns\"}") == std::string::npos)
+    {
+        std::cerr << "Trace is not wrapped as a Chrome trace object\n";
+        return false;
+    }
+
+    if (countOccurrences (json, "\"name\":\"outer\"") != 1 || countOccurrences (json, "\"name\":\"inner\"") != 3
+        || countOccurrences (json, "\"ph\":\"X\"") != 5 || json.find ("worker \\\"quoted\\\"") == std::string::npos)
+    {
+        std::cerr << "Trace does not hold one escaped complete event per scope\n" << json << '\n';
+        return false;
+    }
+
+    if (json.find ("\"tid\":0") == std::string::npos || json.find ("\"tid\":1") == std::string::npos)
+    {
+        std::cerr << "Events from two threads were not given separate thread ids\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool testFullBufferKeepsNewestEvents()
+{
+    // Earlier events on this thread are the oldest, so they are the first to go.
+    auto& buffer = trace::Registry::get().getThreadBuffer();
+    for (std::uint64_t i = 0; i < trace::ThreadBuffer::capacity + 10; ++i)
+        buffer.record ({ "filler", i, i + 1 });
+
+    const auto events = buffer.copyEvents();
+    if (events.size() != trace::ThreadBuffer::capacity || events.back().beginNs != trace::ThreadBuffer::capacity + 9
+        || events.front().beginNs != 10)
+    {
+        std::cerr << "A wrapped buffer did not keep exactly the newest events\n";
+        return false;
+    }
+
+    return true;
+}
+} // namespace
+
+int main()
+{
+    if (! testScopesBecomeChromeTraceEvents())
+        return 1;
+
+    if (! testFullBufferKeepsNewestEvents())
+        return 1;
+
+    std::cout << "Trace tests passed\n";
+    return 0;
+}
@@ -0,0 +1,189 @@
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "../../src/dsp/tuning/TuningTable.h"
+
+namespace
+{
+namespace tuning = secretsynth::dsp::tuning;
+
+bool testTablesTrackPow()
+{
+    for (int note = 0; note < tuning::midiNoteCount; ++note)
+    {
+        const auto expected = 440.0 * std::pow (2.0, (note - 69) / 12.0);
+        if (std::abs (tuning::midiNoteToFrequency (note) / expected - 1.0) > 1.0e-6)
+        {
+            std::cerr << "Equal temperament table is off at note " << note << '\n';
+            return false;
+        }
+    }
+
+    for (auto cents = -9600.0f; cents <= 9600.0f; cents += 0.37f)
+    {
+        const auto expected = std::exp2 (static_cast<double> (cents) / 1200.0);
+        if (std::abs (tuning::centsToRatio (cents) / expected - 1.0) > 1.0e-6)
+        {
+            std::cerr << "Cents table is off at " << cents << " cents\n";
+            return false;
+        }
+    }
+
+    if (tuning::centsToRatio (0.0f) != 1.0f || tuning::octavesToRatio (1.0f) != 2.0f || tuning::octavesToRatio (-1.0f) != 0.5f)
+    {
+        std::cerr << "Whole octaves are not exact\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool testScalaScalesAndMappings()
+{
+    // Twelve-tone equal temperament written in cents reproduces the default table.
+    tuning::TuningTable equal;
+    const auto equalScale = "! 12edo.scl\n!\n12 tone equal temperament\n 12\n!\n"
+                            " 100.0\n 200.\n 300.\n 400.\n 500.\n 600.\n 700.\n 800.\n 900.\n 1000.\n 1100.\n 2/1\n";
+    if (! equal.loadScala (equalScale))
+    {
+        std::cerr << "Rejected a 12-EDO scale\n";
+        return false;
+    }
+
+    for (int note = 0; note < tuning::midiNoteCount; ++note)
+    {
+        if (std::abs (equal.getFrequency (note) / tuning::midiNoteToFrequency (note) - 1.0f) > 1.0e-6f)
+        {
+            std::cerr << "12-EDO scale differs from the default table at note " << note << '\n';
+            return false;
+        }
+    }
+
+    // Just major scale on the white keys, A4 = 432 Hz, black keys and notes below 48 unmapped.
+    tuning::TuningTable just;
+    const auto justScale = "Just major\n7\n9/8\n5/4 major third\n4/3\n3/2\n5/3\n15/8\n2\n";
+    const auto whiteKeys = "12\n48\n127\n60\n69\n432.0\n7\n0\nx\n1\nx\n2\n3\nx\n4\nx\n5\nx\n6\n";
+    if (! just.loadScala (justScale, whiteKeys))
+    {
+        std::cerr << "Rejected a just scale with a keyboard mapping\n";
+        return false;
+    }
+
+    const auto c4 = 432.0f * 3.0f / 5.0f;
+    if (std::abs (just.getFrequency (69) - 432.0f) > 1.0e-3f || std::abs (just.getFrequency (60) - c4) > 1.0e-3f
+        || std::abs (just.getFrequency (64) - c4 * 1.25f) > 1.0e-3f || std::abs (just.getFrequency (72) - c4 * 2.0f) > 1.0e-3f
+        || just.isMapped (61) || just.isMapped (47) || ! just.isMapped (48))
+    {
+        std::cerr << "Keyboard mapping produced unexpected frequencies\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool testMalformedFilesAreRejected()
+{
+    tuning::TuningTable table;
+    const auto validScale = "valid\n1\n2/1\n";
+
+    for (const auto* scale : { "", "no count\n", "short\n3\n100.\n200.\n", "negative\n1\n-3/2\n", "zero period\n1\n0.\n", "junk\n1\n12abc\n" })
+    {
+        if (table.loadScala (scale))
+        {
+            std::cerr << "Accepted malformed scale: " << scale << '\n';
+            return false;
+        }
+    }
+
+    for (const auto* mapping : { "0\n0\n127\n60\n", "0\n0\n200\n60\n69\n440.\n0\n", "0\n0\n127\n60\n69\n-440.\n0\n", "1\n70\n127\n60\n69\n440.\n1\n0\n" })
+    {
+        if (table.loadScala (validScale, mapping))
+        {
+            std::cerr << "Accepted malformed keyboard mapping: " << mapping << '\n';
+            return false;
+        }
+    }
+
+    if (table.getFrequency (69) != 440.0f)
+    {
+        std::cerr << "A rejected file modified the table\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool testSharedTableSwapsWhileReading()
+{
+    tuning::SharedTuningTable shared;
+    if (shared.acquire().getFrequency (69) != 440.0f)
+    {
+        std::cerr << "Shared table does not start in equal temperament\n";
+        return false;
+    }
+
+    // Each published table is a single equal division; a reader must never see two mixed together.
+    std::atomic<bool> done { false };
+    std::atomic<bool> torn { false };
+    std::thread reader ([&]
+    {
+        while (! done.load())
+        {
+            const auto& table = shared.acquire();
+            const auto ratio = table.getFrequency (70) / table.getFrequency (69);
+            for (int note = 1; note < tuning::midiNoteCount; ++note)
+            {
+                if (std::abs (table.getFrequency (note) / table.getFrequency (note - 1) - ratio) > 1.0e-3f)
+                    torn.store (true);
+            }
+        }
+    });
+
+    for (int divisions = 5; divisions < 400; ++divisions)
+    {
+        tuning::TuningTable table;
+        const auto scale = "edo\n1\n" + std::to_string (1200.0 / divisions) + "\n";
+        if (! table.loadScala (scale))
+        {
+            std::cerr << "Rejected generated scale\n";
+            done.store (true);
+            reader.join();
+            return false;
+        }
+
+        shared.publish (table);
+    }
+
+    done.store (true);
+    reader.join();
+
+    if (torn.load())
+    {
+        std::cerr << "Reader saw a table change while it was in use\n";
+        return false;
+    }
+
+    return true;
+}
+} // namespace
+
+int main()
+{
+    if (! testTablesTrackPow())
+        return 1;
+
+    if (! testScalaScalesAndMappings())
+        return 1;
+
+    if (! testMalformedFilesAreRejected())
+        return 1;
+
+    if (! testSharedTableSwapsWhileReading())
+        return 1;
+
+    std::cout << "Tuning tests passed\n";
+    return 0;
+}
@@ -1,10 +1,19 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
+#include <utility>
 #include <vector>
 
 #include "../../src/dsp/voice/VoiceManager.h"
+#include "../support/RealtimeChecker.h"
 
 namespace
 {
+namespace realtime = secretsynth::test::realtime;
 using secretsynth::dsp::voice::Voice;
 using secretsynth::dsp::voice::VoiceManager;
 
@@ -179,43 +188,1267 @@ bool testLegatoAndUnisonAndPrepareUpdates()
     unison.prepare (44100.0, 128);
     unison.noteOn (69, 1.0f);
 
+    // Unison copies are lanes of one stack voice.
     auto activeUnison = 0;
-    std::vector<float> detunes;
+    const Voice* stack = nullptr;
     for (const auto& voice : unison.getVoices())
     {
         if (voice.getState() == Voice::State::active)
         {
             ++activeUnison;
-            detunes.push_back (voice.getDetuneCents());
+            stack = &voice;
         }
     }
 
-    if (activeUnison != 3)
+    if (activeUnison != 1 || stack->getUnisonLaneCount() != 3)
     {
-        std::cerr << "Expected 3 unison voices, got " << activeUnison << '\n';
+        std::cerr << "Expected one 3-lane unison stack, got " << activeUnison << " voices\n";
         return false;
     }
 
-    if (detunes.size() != 3 || detunes[0] != -12.0f || detunes[1] != 0.0f || detunes[2] != 12.0f)
+    if (stack->getLaneDetuneCents (0) != -12.0f || stack->getLaneDetuneCents (1) != 0.0f || stack->getLaneDetuneCents (2) != 12.0f)
     {
         std::cerr << "Unexpected unison detune distribution\n";
         return false;
     }
 
+    if (stack->getLanePan (0) != -1.0f || stack->getLanePan (1) != 0.0f || stack->getLanePan (2) != 1.0f)
+    {
+        std::cerr << "Unexpected unison pan distribution\n";
+        return false;
+    }
+
+    // maxVoices counts lanes: 6 voices of 3-lane unison hold two notes.
+    unison.noteOn (72, 1.0f);
+    unison.noteOn (76, 1.0f);
+    if (unison.getActiveVoiceCount() != 2 || unison.getActiveCapacity() != 2)
+    {
+        std::cerr << "Unison stacks did not respect the lane-counted voice limit\n";
+        return false;
+    }
+
     unison.prepare (96000.0, 32);
     unison.advance (64);
     for (const auto& voice : unison.getVoices())
     {
-        if (voice.getState() != Voice::State::idle && voice.getCurrentPitchHz() <= 0.0f)
+        if (voice.getState() != Voice::State::idle && voice.getCurrentPitchHz() <= 0.0f)
+        {
+            std::cerr << "Invalid pitch after sample-rate/block-size change\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool testRenderFollowsNoteLifecycle()
+{
+    using secretsynth::dsp::mod::Destination;
+    using secretsynth::dsp::mod::ModulationMatrix;
+    using secretsynth::dsp::mod::Source;
+
+    VoiceManager manager ({
+        .mode = VoiceManager::Mode::poly,
+        .maxVoices = 4,
+        .releaseTimeSeconds = 0.01f,
+    });
+
+    manager.prepare (48000.0, 256);
+
+    ModulationMatrix matrix;
+    matrix.addRoute ({ Source::ampEnv, Destination::amp, 1.0f, false });
+
+    Voice::RenderParameters parameters;
+    parameters.ampEnvelope = { 0.001f, 0.05f, 0.9f, 0.01f };
+
+    std::vector<float> lfo (256, 0.5f);
+    const Voice::RenderContext context { &parameters, &matrix, lfo.data(), lfo.data() };
+
+    const auto renderPeak = [&manager, &context] {
+        std::vector<float> left (256, 0.0f);
+        std::vector<float> right (256, 0.0f);
+        manager.render (left.data(), right.data(), static_cast<int> (left.size()), context);
+
+        auto peak = 0.0f;
+        for (std::size_t i = 0; i < left.size(); ++i)
+            peak = std::max ({ peak, std::abs (left[i]), std::abs (right[i]) });
+        return peak;
+    };
+
+    if (renderPeak() != 0.0f)
+    {
+        std::cerr << "Idle manager rendered non-zero output\n";
+        return false;
+    }
+
+    manager.noteOn (57, 1.0f);
+    manager.noteOn (64, 1.0f);
+    if (manager.getActiveVoiceCount() != 2 || renderPeak() <= 1.0e-3f)
+    {
+        std::cerr << "Held notes did not render audible output\n";
+        return false;
+    }
+
+    manager.noteOff (57);
+    manager.noteOff (64);
+    for (int block = 0; block < 4; ++block)
+        renderPeak();
+
+    if (manager.getActiveVoiceCount() != 0 || renderPeak() != 0.0f)
+    {
+        std::cerr << "Released voices kept rendering after their release time\n";
+        return false;
+    }
+
+    return true;
+}
+
+int countNonIdle (const VoiceManager& manager)
+{
+    return static_cast<int> (std::count_if (manager.getVoices().begin(), manager.getVoices().end(), [] (const Voice& voice) {
+        return voice.getState() != Voice::State::idle;
+    }));
+}
+
+// Median cost per event of a random note-on/note-off storm against a busy pool.
+double measureStormNanosPerEvent (std::size_t maxVoices)
+{
+    VoiceManager manager ({
+        .mode = VoiceManager::Mode::poly,
+        .maxVoices = maxVoices,
+        .releaseTimeSeconds = 1.0f,
+    });
+
+    manager.prepare (48000.0, 64, maxVoices);
+    for (std::size_t i = 0; i < maxVoices; ++i)
+        manager.noteOn (static_cast<int> (i % 128), 1.0f);
+
+    constexpr int eventsPerRun = 4096;
+    std::vector<double> runs;
+    std::uint32_t seed = 12345u;
+
+    for (int run = 0; run < 9; ++run)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < eventsPerRun; ++i)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            const auto note = static_cast<int> ((seed >> 8) % 128u);
+            manager.noteOn (note, 0.8f);
+            if ((seed & 3u) == 0u)
+                manager.noteOff (static_cast<int> ((seed >> 16) % 128u));
+        }
+        const auto elapsed = std::chrono::duration<double, std::nano> (std::chrono::steady_clock::now() - start).count();
+        runs.push_back (elapsed / eventsPerRun);
+    }
+
+    std::sort (runs.begin(), runs.end());
+    return runs[runs.size() / 2];
+}
+
+bool testMidiStormKeepsAllocationConsistentAndFlat()
+{
+    VoiceManager manager ({
+        .mode = VoiceManager::Mode::unison,
+        .maxVoices = 96,
+        .unisonVoices = 3,
+        .releaseTimeSeconds = 0.005f,
+    });
+
+    manager.prepare (48000.0, 32, 96);
+
+    std::uint32_t seed = 7u;
+    for (int step = 0; step < 20000; ++step)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        const auto note = static_cast<int> ((seed >> 8) % 128u);
+
+        if ((seed >> 24) % 3u == 0u)
+            manager.noteOff (note);
+        else
+            manager.noteOn (note, 1.0f);
+
+        if (step % 16 == 0)
+            manager.advance (32);
+
+        if (step % 997 == 0)
+            manager.allNotesOff();
+
+        if (manager.getActiveVoiceCount() != countNonIdle (manager))
+        {
+            std::cerr << "Voice lists out of sync at step " << step << ": tracked " << manager.getActiveVoiceCount()
+                      << ", actual " << countNonIdle (manager) << '\n';
+            return false;
+        }
+    }
+
+    manager.allNotesOff();
+    for (int block = 0; block < 16; ++block)
+        manager.advance (32);
+
+    if (manager.getActiveVoiceCount() != 0 || countNonIdle (manager) != 0)
+    {
+        std::cerr << "Voices left sounding after storm\n";
+        return false;
+    }
+
+    const auto smallCost = measureStormNanosPerEvent (16);
+    const auto largeCost = measureStormNanosPerEvent (1024);
+    std::cout << "storm cost ns/event: 16 voices=" << smallCost << ", 1024 voices=" << largeCost << '\n';
+
+    // 64x more voices; any per-event scan over the voice pool shows up as a multiple here.
+    if (largeCost > smallCost * 2.0 + 50.0)
+    {
+        std::cerr << "Voice allocation cost grew with voice count\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool testNoteEventsDoNotAllocateAfterPrepare()
+{
+    for (const auto mode : { VoiceManager::Mode::poly, VoiceManager::Mode::mono, VoiceManager::Mode::legato, VoiceManager::Mode::unison })
+    {
+        VoiceManager manager ({
+            .mode = mode,
+            .maxVoices = 16,
+            .unisonVoices = 4,
+            .releaseTimeSeconds = 0.01f,
+            .glideTimeSeconds = 0.05f,
+        });
+
+        manager.prepare (48000.0, 128);
+        realtime::reset();
+
+        {
+            const realtime::ScopedAudioThread audioThread;
+
+            std::uint32_t seed = 99u;
+            for (int step = 0; step < 5000; ++step)
+            {
+                seed = seed * 1664525u + 1013904223u;
+                const auto note = static_cast<int> ((seed >> 8) % 128u);
+
+                if ((seed >> 20) % 2u == 0u)
+                    manager.noteOn (note, 0.9f);
+                else
+                    manager.noteOff (note);
+
+                if (step % 8 == 0)
+                    manager.advance (64);
+            }
+
+            manager.allNotesOff();
+        }
+
+        if (! realtime::reportViolations ("noteOn/noteOff"))
+        {
+            std::cerr << "Note events were not realtime safe in mode " << static_cast<int> (mode) << '\n';
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool testLegatoReturnsThroughHeldStack()
+{
+    VoiceManager legato ({ .mode = VoiceManager::Mode::legato });
+    legato.prepare (48000.0, 64);
+
+    legato.noteOn (60, 0.5f);
+    legato.noteOn (64, 0.6f);
+    legato.noteOn (67, 0.7f);
+    legato.noteOn (64, 0.8f); // re-press moves 64 to the top of the stack
+    legato.noteOff (64);
+
+    if (legato.getVoices().front().getMidiNote() != 67)
+    {
+        std::cerr << "Legato did not fall back to the most recent remaining key\n";
+        return false;
+    }
+
+    legato.noteOff (60);
+    legato.noteOff (67);
+
+    if (legato.getVoices().front().getState() != Voice::State::releasing)
+    {
+        std::cerr << "Legato voice did not release once every key was up\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool testConfigChangesOnlyMoveCapacityWindow()
+{
+    VoiceManager manager ({
+        .mode = VoiceManager::Mode::poly,
+        .maxVoices = 8,
+        .releaseTimeSeconds = 0.01f,
+    });
+
+    manager.prepare (48000.0, 64);
+    const auto* storage = manager.getVoices().data();
+    const auto poolSize = manager.getVoices().size();
+
+    for (int note = 60; note < 68; ++note)
+        manager.noteOn (note, 1.0f);
+
+    realtime::reset();
+
+    {
+        const realtime::ScopedAudioThread audioThread;
+
+        manager.setConfig ({ .mode = VoiceManager::Mode::poly, .maxVoices = 4, .releaseTimeSeconds = 0.01f });
+
+        const auto& voices = manager.getVoices();
+        for (std::size_t index = 4; index < 8; ++index)
+        {
+            if (voices[index].getState() != Voice::State::releasing)
+            {
+                std::cerr << "Voice outside the shrunk window was not released gracefully\n";
+                return false;
+            }
+        }
+
+        for (int note = 80; note < 90; ++note)
+            manager.noteOn (note, 1.0f);
+
+        for (std::size_t index = 4; index < voices.size(); ++index)
+        {
+            if (voices[index].getMidiNote() >= 80)
+            {
+                std::cerr << "Voice outside the active window was reallocated\n";
+                return false;
+            }
+        }
+
+        manager.advance (1024);
+        if (manager.getActiveVoiceCount() != 4)
+        {
+            std::cerr << "Expected only the 4 in-window voices after the release tail, got " << manager.getActiveVoiceCount() << '\n';
+            return false;
+        }
+
+        manager.setConfig ({ .mode = VoiceManager::Mode::mono });
+        manager.setConfig ({ .mode = VoiceManager::Mode::poly, .maxVoices = 16 });
+        for (int note = 30; note < 46; ++note)
+            manager.noteOn (note, 1.0f);
+    }
+
+    if (! realtime::reportViolations ("VoiceManager::setConfig") || manager.getVoices().data() != storage
+        || manager.getVoices().size() != poolSize)
+    {
+        std::cerr << "Config changes reallocated the voice pool\n";
+        return false;
+    }
+
+    if (manager.getActiveCapacity() != 16 || manager.getActiveVoiceCount() != 16)
+    {
+        std::cerr << "Regrown window did not allocate 16 voices\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool testPerSampleGlideCurves()
+{
+    using secretsynth::dsp::voice::GlideCurve;
+
+    constexpr double sampleRate = 48000.0;
+    constexpr float glideSeconds = 0.01f; // 480 samples
+    constexpr int glideSamples = 480;
+    const Voice::NoteEvent event { 81, 1.0f, 1, 0, 0.0f, 0.0f }; // A5 = 880 Hz
+
+    for (const auto curve : { GlideCurve::linear, GlideCurve::exponential })
+    {
+        Voice voice;
+        voice.prepare (sampleRate, 64);
+        voice.startNote (event, 440.0f, glideSeconds, curve, true);
+
+        std::vector<float> pitch (glideSamples + 16);
+        auto written = 0;
+        for (const auto chunk : { 7, 64, 1, 200, 224 })
+        {
+            voice.renderPitch (pitch.data() + written, chunk);
+            written += chunk;
+        }
+
+        const auto halfway = pitch[glideSamples / 2];
+        const auto expectedHalfway = curve == GlideCurve::linear ? 660.0f : 440.0f * std::sqrt (2.0f);
+        if (std::abs (pitch[0] - 440.0f) > 1.0e-3f || std::abs (halfway - expectedHalfway) > 0.05f)
+        {
+            std::cerr << "Glide curve " << static_cast<int> (curve) << " off trajectory: start " << pitch[0] << ", halfway "
+                      << halfway << " (expected " << expectedHalfway << ")\n";
+            return false;
+        }
+
+        for (int i = 1; i < written; ++i)
+        {
+            if (pitch[static_cast<std::size_t> (i)] < pitch[static_cast<std::size_t> (i - 1)])
+            {
+                std::cerr << "Upward glide was not monotonic at sample " << i << '\n';
+                return false;
+            }
+        }
+
+        if (pitch[static_cast<std::size_t> (written - 1)] != 880.0f || voice.getCurrentPitchHz() != 880.0f)
+        {
+            std::cerr << "Glide did not land exactly on the target pitch\n";
+            return false;
+        }
+
+        // advance() must follow the same trajectory as renderPitch().
+        Voice advanced;
+        advanced.prepare (sampleRate, 64);
+        advanced.startNote (event, 440.0f, glideSeconds, curve, true);
+        advanced.advance (glideSamples / 2);
+        if (std::abs (advanced.getCurrentPitchHz() - halfway) > 1.0e-3f)
+        {
+            std::cerr << "advance() diverged from renderPitch()\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+} // namespace
+
+bool testInaudibleReleasingVoicesSleepEarly()
+{
+    using secretsynth::dsp::mod::Destination;
+    using secretsynth::dsp::mod::ModulationMatrix;
+    using secretsynth::dsp::mod::Source;
+
+    Voice::RenderParameters parameters;
+    parameters.ampEnvelope = { 0.001f, 0.05f, 0.9f, 5.0f };
+
+    std::vector<float> lfo (256, 0.5f);
+    std::vector<float> output (256, 0.0f);
+    std::vector<float> right (256, 0.0f);
+
+    const auto blocksUntilIdle = [&parameters, &lfo, &output, &right] (float ampDepth) {
+        VoiceManager manager ({
+            .mode = VoiceManager::Mode::poly,
+            .maxVoices = 4,
+            .releaseTimeSeconds = 5.0f,
+        });
+        manager.prepare (48000.0, 256);
+
+        ModulationMatrix matrix;
+        matrix.addRoute ({ Source::ampEnv, Destination::amp, ampDepth, false });
+        const Voice::RenderContext context { &parameters, &matrix, lfo.data(), lfo.data() };
+
+        manager.noteOn (60, 1.0f);
+        for (int block = 0; block < 8; ++block)
+            manager.render (output.data(), right.data(), static_cast<int> (output.size()), context);
+
+        manager.noteOff (60);
+        for (int block = 0; block < 64; ++block)
+        {
+            manager.render (output.data(), right.data(), static_cast<int> (output.size()), context);
+            if (manager.getActiveVoiceCount() == 0)
+                return block;
+        }
+
+        return -1;
+    };
+
+    const auto quietBlocks = blocksUntilIdle (1.0e-4f);
+    if (quietBlocks < 0 || quietBlocks > 16)
+    {
+        std::cerr << "Inaudible releasing voice kept rendering for its full release time\n";
+        return false;
+    }
+
+    if (blocksUntilIdle (1.0f) != -1)
+    {
+        std::cerr << "Audible releasing voice was put to sleep early\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool testGovernorShedsAndRestoresVoices()
+{
+    using secretsynth::dsp::mod::Destination;
+    using secretsynth::dsp::mod::ModulationMatrix;
+    using secretsynth::dsp::mod::Source;
+
+    VoiceManager manager ({
+        .mode = VoiceManager::Mode::poly,
+        .maxVoices = 16,
+        .releaseTimeSeconds = 2.0f,
+    });
+    manager.prepare (48000.0, 256);
+    manager.setGovernorConfig (
+        { .budgetFraction = 0.5f, .overloadBlocks = 3, .recoveryFraction = 0.5f, .recoveryBlocks = 4, .minimumVoices = 2, .fadeTimeSeconds = 0.002f });
+
+    ModulationMatrix matrix;
+    matrix.addRoute ({ Source::ampEnv, Destination::amp, 1.0f, false });
+
+    Voice::RenderParameters parameters;
+    parameters.ampEnvelope = { 0.001f, 0.05f, 0.9f, 2.0f };
+
+    std::vector<float> lfo (256, 0.5f);
+    std::vector<float> output (256, 0.0f);
+    std::vector<float> right (256, 0.0f);
+    const Voice::RenderContext context { &parameters, &matrix, lfo.data(), lfo.data() };
+    const auto render = [&] { manager.render (output.data(), right.data(), static_cast<int> (output.size()), context); };
+    constexpr auto blockSeconds = 256.0 / 48000.0;
+
+    for (int note = 60; note < 68; ++note)
+        manager.noteOn (note, 1.0f);
+
+    render();
+    for (int note = 60; note < 64; ++note)
+        manager.noteOff (note);
+
+    render();
+
+    // Twice the budget, sustained for overloadBlocks blocks, halves the cap; the releasing voices go first.
+    manager.reportRenderTime (blockSeconds, 256);
+    manager.reportRenderTime (blockSeconds, 256);
+    if (manager.getVoiceCap() != 16)
+    {
+        std::cerr << "Governor shed voices before the overload was sustained\n";
+        return false;
+    }
+
+    manager.reportRenderTime (blockSeconds, 256);
+    if (manager.getVoiceCap() != 4)
+    {
+        std::cerr << "Governor did not scale the voice cap to the overload\n";
+        return false;
+    }
+
+    for (const auto& voice : manager.getVoices())
+    {
+        if (voice.getState() == Voice::State::active && voice.isFadingOut())
+        {
+            std::cerr << "Governor faded a held voice while releasing voices were available\n";
+            return false;
+        }
+    }
+
+    render();
+    if (manager.getActiveVoiceCount() != 4)
+    {
+        std::cerr << "Shed voices did not finish their fade within a block\n";
+        return false;
+    }
+
+    manager.noteOn (72, 1.0f);
+    if (manager.getActiveVoiceCount() != 4)
+    {
+        std::cerr << "Note-on exceeded the governed voice cap\n";
+        return false;
+    }
+
+    for (int block = 0; block < 4; ++block)
+        manager.reportRenderTime (blockSeconds * 0.1, 256);
+
+    if (manager.getVoiceCap() != 5)
+    {
+        std::cerr << "Governor did not restore a voice after sustained headroom\n";
+        return false;
+    }
+
+    manager.noteOn (74, 1.0f);
+    if (manager.getActiveVoiceCount() != 5)
+    {
+        std::cerr << "Restored cap did not admit another voice\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool testGovernorIgnoresSingleSlowBlocks()
+{
+    VoiceManager manager ({
+        .mode = VoiceManager::Mode::poly,
+        .maxVoices = 16,
+        .releaseTimeSeconds = 2.0f,
+    });
+    manager.prepare (48000.0, 256);
+    manager.setGovernorConfig ({ .budgetFraction = 0.7f });
+
+    for (int note = 60; note < 72; ++note)
+        manager.noteOn (note, 1.0f);
+
+    // Isolated spikes far over budget, each followed by ordinary blocks, as a page fault or a
+    // preempted thread would produce.
+    constexpr auto blockSeconds = 256.0 / 48000.0;
+    for (int spike = 0; spike < 20; ++spike)
+    {
+        manager.reportRenderTime (blockSeconds * 10.0, 256);
+        manager.reportRenderTime (blockSeconds * 0.6, 256);
+        manager.reportRenderTime (blockSeconds * 0.6, 256);
+    }
+
+    if (manager.getVoiceCap() != 16)
+    {
+        std::cerr << "A single slow block changed the voice cap to " << manager.getVoiceCap() << '\n';
+        return false;
+    }
+
+    for (const auto& voice : manager.getVoices())
+    {
+        if (voice.isFadingOut())
+        {
+            std::cerr << "A single slow block faded a held voice\n";
+            return false;
+        }
+    }
+
+    return manager.getActiveVoiceCount() == 12;
+}
+
+bool testStolenVoicesFadeThroughGhosts()
+{
+    using secretsynth::dsp::mod::Destination;
+    using secretsynth::dsp::mod::ModulationMatrix;
+    using secretsynth::dsp::mod::Source;
+
+    VoiceManager manager ({
+        .mode = VoiceManager::Mode::poly,
+        .maxVoices = 1,
+        .releaseTimeSeconds = 0.2f,
+    });
+    manager.prepare (48000.0, 256);
+
+    ModulationMatrix matrix;
+    matrix.addRoute ({ Source::ampEnv, Destination::amp, 1.0f, false });
+
+    Voice::RenderParameters parameters;
+    parameters.ampEnvelope = { 0.001f, 0.05f, 0.9f, 0.2f };
+    parameters.filterCutoffHz = 20000.0f;
+
+    std::vector<float> lfo (256, 0.5f);
+    std::vector<float> output (256, 0.0f);
+    std::vector<float> right (256, 0.0f);
+    const Voice::RenderContext context { &parameters, &matrix, lfo.data(), lfo.data() };
+
+    manager.noteOn (45, 1.0f);
+    for (int block = 0; block < 8; ++block)
+    {
+        std::fill (output.begin(), output.end(), 0.0f);
+    std::fill (right.begin(), right.end(), 0.0f);
+        manager.render (output.data(), right.data(), static_cast<int> (output.size()), context);
+    }
+
+    auto peak = 0.0f;
+    auto largestStep = 0.0f;
+    for (std::size_t i = 1; i < output.size(); ++i)
+    {
+        peak = std::max (peak, std::abs (output[i]));
+        largestStep = std::max (largestStep, std::abs (output[i] - output[i - 1]));
+    }
+
+    const auto lastSample = output.back();
+    manager.noteOn (81, 1.0f);
+
+    if (manager.getActiveVoiceCount() != 1 || manager.getGhostVoiceCount() != 1)
+    {
+        std::cerr << "Stolen voice was not handed to a fade-out ghost\n";
+        return false;
+    }
+
+    std::fill (output.begin(), output.end(), 0.0f);
+    std::fill (right.begin(), right.end(), 0.0f);
+    manager.render (output.data(), right.data(), static_cast<int> (output.size()), context);
+
+    if (peak <= 1.0e-3f || std::abs (output.front() - lastSample) > largestStep * 2.0f)
+    {
+        std::cerr << "Voice steal produced a discontinuity\n";
+        return false;
+    }
+
+    if (manager.getGhostVoiceCount() != 0)
+    {
+        std::cerr << "Ghost voice outlived its fade\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool testParallelRenderMatchesSerial()
+{
+    using secretsynth::dsp::mod::Destination;
+    using secretsynth::dsp::mod::ModulationMatrix;
+    using secretsynth::dsp::mod::Source;
+    using secretsynth::dsp::voice::RenderThreadPool;
+
+    const VoiceManager::Config config {
+        .mode = VoiceManager::Mode::unison,
+        .maxVoices = 64,
+        .unisonVoices = 4,
+        .releaseTimeSeconds = 0.05f,
+    };
+
+    VoiceManager serial (config);
+    VoiceManager parallel (config);
+    RenderThreadPool pool (3);
+
+    serial.prepare (48000.0, 256);
+    parallel.prepare (48000.0, 256);
+
+    // A deadline no build type can reach, so no voice is ever cut short here.
+    parallel.setRenderThreadPool (&pool, 1.0e6);
+
+    ModulationMatrix matrix;
+    matrix.addRoute ({ Source::ampEnv, Destination::amp, 1.0f, false });
+    matrix.addRoute ({ Source::lfo1, Destination::pdAmount, 0.25f, true });
+
+    Voice::RenderParameters parameters;
+    parameters.ampEnvelope = { 0.001f, 0.05f, 0.9f, 0.05f };
+
+    std::vector<float> lfo (256, 0.0f);
+    for (std::size_t i = 0; i < lfo.size(); ++i)
+        lfo[i] = static_cast<float> (i) / static_cast<float> (lfo.size());
+
+    const Voice::RenderContext context { &parameters, &matrix, lfo.data(), lfo.data() };
+    std::vector<float> serialLeft (256, 0.0f);
+    std::vector<float> serialRight (256, 0.0f);
+    std::vector<float> parallelLeft (256, 0.0f);
+    std::vector<float> parallelRight (256, 0.0f);
+
+    for (int block = 0; block < 24; ++block)
+    {
+        // 16 notes x 4 unison, then releases and steals so ghosts and releasing voices join in.
+        for (auto* manager : { &serial, &parallel })
+        {
+            if (block < 16)
+                manager->noteOn (48 + block, 0.8f);
+            else if (block == 16)
+                for (int note = 48; note < 56; ++note)
+                    manager->noteOff (note);
+            else if (block == 18)
+                manager->noteOn (90, 1.0f);
+        }
+
+        for (auto* buffer : { &serialLeft, &serialRight, &parallelLeft, &parallelRight })
+            std::fill (buffer->begin(), buffer->end(), 0.0f);
+
+        if (block % 3 == 1)
+        {
+            // One dispatch over several slices has to match rendering the slices one at a time.
+            const std::array<VoiceManager::RenderSlice, 3> slices { {
+                { 40, context },
+                { 100, { &parameters, &matrix, lfo.data() + 40, lfo.data() + 40 } },
+                { 116, { &parameters, &matrix, lfo.data() + 140, lfo.data() + 140 } },
+            } };
+
+            auto offset = 0;
+            for (const auto& slice : slices)
+            {
+                serial.render (serialLeft.data() + offset, serialRight.data() + offset, slice.numSamples, slice.context);
+                offset += slice.numSamples;
+            }
+
+            parallel.render (parallelLeft.data(), parallelRight.data(), slices);
+        }
+        else
+        {
+            // Alternate block sizes so the serial fallback is exercised in the parallel manager too.
+            const auto numSamples = (block % 3 == 2) ? 32 : 256;
+            serial.render (serialLeft.data(), serialRight.data(), numSamples, context);
+            parallel.render (parallelLeft.data(), parallelRight.data(), numSamples, context);
+        }
+
+        if (serialLeft != parallelLeft || serialRight != parallelRight || serial.getActiveVoiceCount() != parallel.getActiveVoiceCount())
+        {
+            std::cerr << "Parallel voice rendering diverged from serial rendering in block " << block << "\n";
+            return false;
+        }
+    }
+
+    if (serial.getActiveVoiceCount() < VoiceManager::minimumParallelVoices)
+    {
+        std::cerr << "Parallel render test never reached the parallel voice threshold\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool testUnisonSpreadPansLanes()
+{
+    using secretsynth::dsp::mod::Destination;
+    using secretsynth::dsp::mod::ModulationMatrix;
+    using secretsynth::dsp::mod::Source;
+
+    ModulationMatrix matrix;
+    matrix.addRoute ({ Source::ampEnv, Destination::amp, 1.0f, false });
+
+    Voice::RenderParameters parameters;
+    std::vector<float> lfo (256, 0.5f);
+    const Voice::RenderContext context { &parameters, &matrix, lfo.data(), lfo.data() };
+
+    const auto renderStereo = [&context] (VoiceManager::Mode mode, float spread) {
+        VoiceManager manager ({
+            .mode = mode,
+            .maxVoices = 8,
+            .unisonVoices = 2,
+            .unisonDetuneCents = 15.0f,
+            .unisonSpread = spread,
+        });
+        manager.prepare (48000.0, 256);
+        manager.noteOn (60, 1.0f);
+
+        std::vector<float> left (256, 0.0f);
+        std::vector<float> right (256, 0.0f);
+        for (int block = 0; block < 4; ++block)
+            manager.render (left.data(), right.data(), 256, context);
+
+        auto difference = 0.0f;
+        auto peak = 0.0f;
+        for (std::size_t i = 0; i < left.size(); ++i)
         {
-            std::cerr << "Invalid pitch after sample-rate/block-size change\n";
+            difference = std::max (difference, std::abs (left[i] - right[i]));
+            peak = std::max (peak, std::abs (left[i]));
+        }
+
+        return std::pair { peak, difference };
+    };
+
+    const auto [centredPeak, centredDifference] = renderStereo (VoiceManager::Mode::poly, 1.0f);
+    if (centredPeak <= 1.0e-3f || centredDifference != 0.0f)
+    {
+        std::cerr << "A centred voice did not render identical channels\n";
+        return false;
+    }
+
+    const auto [spreadPeak, spreadDifference] = renderStereo (VoiceManager::Mode::unison, 1.0f);
+    if (spreadPeak <= 1.0e-3f || spreadDifference <= 1.0e-3f)
+    {
+        std::cerr << "Unison spread did not pan lanes apart\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool testTuningTableDrivesNotePitch()
+{
+    // Five-note equal division with every other key unmapped; each mapping repeat climbs one step.
+    secretsynth::dsp::tuning::TuningTable tuning;
+    const auto loaded = tuning.loadScala ("5-EDO\n5\n240.\n480.\n720.\n960.\n2/1\n",
+                                          "2\n0\n127\n60\n60\n261.6\n1\n0\nx\n");
+    if (! loaded)
+    {
+        std::cerr << "Tuning table rejected a valid scale\n";
+        return false;
+    }
+
+    VoiceManager manager ({ .mode = VoiceManager::Mode::poly, .maxVoices = 4 });
+    manager.prepare (48000.0, 64);
+    manager.setTuning (&tuning);
+
+    manager.noteOn (61, 1.0f);
+    if (manager.getActiveVoiceCount() != 0)
+    {
+        std::cerr << "Unmapped key started a voice\n";
+        return false;
+    }
+
+    manager.noteOn (62, 1.0f);
+    const auto* voice = manager.getNewestVoice();
+    if (voice == nullptr || std::abs (voice->getCurrentPitchHz() - 261.6f * std::exp2 (240.0f / 1200.0f)) > 1.0e-2f)
+    {
+        std::cerr << "Mapped key did not use the tuning table pitch\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool testUnchangedRevisionSkipsParameterSetters()
+{
+    using secretsynth::dsp::mod::Destination;
+    using secretsynth::dsp::mod::ModulationMatrix;
+    using secretsynth::dsp::mod::Source;
+
+    ModulationMatrix matrix;
+    matrix.addRoute ({ Source::ampEnv, Destination::amp, 1.0f, false });
+
+    Voice::RenderParameters parameters;
+    parameters.revision = 1;
+    const Voice::RenderContext context { &parameters, &matrix, nullptr, nullptr };
+
+    Voice tracked;
+    Voice reference;
+    for (auto* voice : { &tracked, &reference })
+    {
+        voice->prepare (48000.0, 64);
+        voice->startNote ({ .midiNote = 60, .velocity = 1.0f, .eventIndex = 1 }, 0.0f, 0.0f, secretsynth::dsp::voice::GlideCurve::linear, true);
+    }
+
+    const auto renderBoth = [&] (const Voice::RenderParameters& trackedParameters)
+    {
+        std::vector<float> trackedLeft (64, 0.0f), trackedRight (64, 0.0f), referenceLeft (64, 0.0f), referenceRight (64, 0.0f);
+        const Voice::RenderContext trackedContext { &trackedParameters, &matrix, nullptr, nullptr };
+        tracked.render (trackedLeft.data(), trackedRight.data(), 64, trackedContext);
+        reference.render (referenceLeft.data(), referenceRight.data(), 64, context);
+        return trackedLeft == referenceLeft && trackedRight == referenceRight;
+    };
+
+    renderBoth (parameters);
+
+    // Same revision: the voice keeps its applied settings even though the struct changed.
+    auto retuned = parameters;
+    retuned.tuneSemitones = 7.0f;
+    if (! renderBoth (retuned))
+    {
+        std::cerr << "Voice re-applied parameters for an unchanged revision\n";
+        return false;
+    }
+
+    retuned.revision = 2;
+    if (renderBoth (retuned))
+    {
+        std::cerr << "Voice ignored a new parameter revision\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool testRenderContextRampsOverrideParameters()
+{
+    using secretsynth::dsp::mod::Destination;
+    using secretsynth::dsp::mod::ModulationMatrix;
+    using secretsynth::dsp::mod::Source;
+
+    ModulationMatrix matrix;
+    matrix.addRoute ({ Source::ampEnv, Destination::amp, 1.0f, false });
+
+    // A constant ramp must render exactly like the same value in RenderParameters.
+    Voice::RenderParameters stepped;
+    stepped.filterCutoffHz = 600.0f;
+    stepped.pdAmount = 0.2f;
+
+    Voice::RenderParameters ramped;
+    const std::vector<float> cutoffRamp (128, 600.0f);
+    const std::vector<float> pdAmountRamp (128, 0.2f);
+
+    const Voice::RenderContext steppedContext { &stepped, &matrix, nullptr, nullptr };
+    const Voice::RenderContext rampedContext { &ramped, &matrix, nullptr, nullptr, pdAmountRamp.data(), cutoffRamp.data() };
+
+    std::vector<std::vector<float>> outputs;
+    for (const auto* context : { &steppedContext, &rampedContext })
+    {
+        Voice voice;
+        voice.prepare (48000.0, 128);
+        voice.startNote ({ .midiNote = 48, .velocity = 1.0f, .eventIndex = 1 }, 0.0f, 0.0f, secretsynth::dsp::voice::GlideCurve::linear, true);
+
+        std::vector<float> left (128, 0.0f), right (128, 0.0f);
+        voice.render (left.data(), right.data(), 128, *context);
+        outputs.push_back (left);
+    }
+
+    if (outputs[0] != outputs[1])
+    {
+        std::cerr << "Render context ramps were not used in place of the parameter values\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool testControlBlocksIgnoreRenderSplits()
+{
+    using secretsynth::dsp::mod::Destination;
+    using secretsynth::dsp::mod::ModulationMatrix;
+    using secretsynth::dsp::mod::Source;
+
+    ModulationMatrix matrix;
+    matrix.addRoute ({ Source::ampEnv, Destination::amp, 1.0f, false });
+    matrix.addRoute ({ Source::modEnv, Destination::filterCutoff, 0.5f, false });
+    matrix.addRoute ({ Source::lfo1, Destination::pdAmount, 0.3f, true });
+
+    constexpr int numSamples = 16 * Voice::controlBlockSize;
+    std::vector<float> lfo (numSamples, 0.0f);
+    for (int i = 0; i < numSamples; ++i)
+        lfo[static_cast<std::size_t> (i)] = 0.5f + 0.5f * std::sin (static_cast<float> (i) * 0.01f);
+
+    Voice::RenderParameters parameters;
+    const Voice::RenderContext context { &parameters, &matrix, lfo.data(), lfo.data() };
+
+    // One long render and renders split on the control grid must produce the same samples.
+    std::vector<std::vector<float>> outputs;
+    for (const auto split : { numSamples, Voice::controlBlockSize, 2 * Voice::controlBlockSize })
+    {
+        Voice voice;
+        voice.prepare (48000.0, numSamples);
+        voice.startNote ({ .midiNote = 57, .velocity = 1.0f, .eventIndex = 1, .unisonLanes = 3, .unisonDetuneCents = 7.0f, .unisonSpread = 0.5f },
+                         0.0f,
+                         0.0f,
+                         secretsynth::dsp::voice::GlideCurve::linear,
+                         true);
+
+        std::vector<float> left (numSamples, 0.0f), right (numSamples, 0.0f);
+        for (int start = 0; start < numSamples; start += split)
+        {
+            const Voice::RenderContext offset { &parameters, &matrix, context.lfo1 + start, context.lfo2 + start };
+            voice.render (left.data() + start, right.data() + start, split, offset);
+        }
+
+        outputs.push_back (left);
+    }
+
+    if (outputs[0] != outputs[1] || outputs[0] != outputs[2])
+    {
+        std::cerr << "Voice output depends on how the host splits control-aligned blocks\n";
+        return false;
+    }
+
+    // Amplitude is interpolated within a control block, so the attack starts without a step.
+    if (std::abs (outputs[0][0]) > 1.0e-4f)
+    {
+        std::cerr << "Attack started with a step of " << outputs[0][0] << '\n';
+        return false;
+    }
+
+    return true;
+}
+
+bool testRestartedVoiceStartsLikeFreshVoice()
+{
+    using secretsynth::dsp::mod::Destination;
+    using secretsynth::dsp::mod::ModulationMatrix;
+    using secretsynth::dsp::mod::Source;
+
+    ModulationMatrix matrix;
+    matrix.addRoute ({ Source::ampEnv, Destination::amp, 1.0f, false });
+
+    Voice::RenderParameters parameters;
+    parameters.ampEnvelope = { 0.01f, 0.05f, 0.9f, 0.2f };
+
+    constexpr int blockSize = Voice::controlBlockSize;
+    std::vector<float> lfo (blockSize, 0.5f);
+    const Voice::RenderContext context { &parameters, &matrix, lfo.data(), lfo.data() };
+
+    const auto startNote = [] (Voice& voice, int midiNote)
+    {
+        voice.startNote ({ .midiNote = midiNote, .velocity = 1.0f, .eventIndex = 1 }, 0.0f, 0.0f, secretsynth::dsp::voice::GlideCurve::linear, true);
+    };
+
+    // A stolen slot has been sounding at sustain level; its first block must not carry that gain
+    // or the old note's filter state into the new note.
+    Voice reused;
+    reused.prepare (48000.0, blockSize);
+    startNote (reused, 45);
+
+    std::vector<float> left (blockSize, 0.0f), right (blockSize, 0.0f);
+    for (int block = 0; block < 200; ++block)
+        reused.render (left.data(), right.data(), blockSize, context);
+
+    Voice fresh;
+    fresh.prepare (48000.0, blockSize);
+
+    startNote (reused, 81);
+    startNote (fresh, 81);
+
+    std::vector<float> reusedLeft (blockSize, 0.0f), freshLeft (blockSize, 0.0f);
+    reused.render (reusedLeft.data(), right.data(), blockSize, context);
+    fresh.render (freshLeft.data(), right.data(), blockSize, context);
+
+    for (std::size_t i = 0; i < reusedLeft.size(); ++i)
+    {
+        if (std::abs (reusedLeft[i] - freshLeft[i]) > 1.0e-6f)
+        {
+            std::cerr << "Restarted voice differs from a fresh one at sample " << i << ": " << reusedLeft[i] << " vs " << freshLeft[i] << '\n';
             return false;
         }
     }
 
     return true;
 }
-} // namespace
+
+bool testIdleTracksReleasesAndGhosts()
+{
+    using secretsynth::dsp::mod::Destination;
+    using secretsynth::dsp::mod::ModulationMatrix;
+    using secretsynth::dsp::mod::Source;
+
+    VoiceManager manager ({
+        .mode = VoiceManager::Mode::poly,
+        .maxVoices = 1,
+        .releaseTimeSeconds = 0.05f,
+    });
+    manager.prepare (48000.0, 256);
+
+    ModulationMatrix matrix;
+    matrix.addRoute ({ Source::ampEnv, Destination::amp, 1.0f, false });
+    Voice::RenderParameters parameters;
+    parameters.ampEnvelope = { 0.001f, 0.05f, 0.9f, 0.05f };
+    std::vector<float> lfo (256, 0.5f), left (256, 0.0f), right (256, 0.0f);
+    const Voice::RenderContext context { &parameters, &matrix, lfo.data(), lfo.data() };
+
+    if (! manager.isIdle())
+    {
+        std::cerr << "Fresh manager is not idle\n";
+        return false;
+    }
+
+    // The second note steals the only voice, leaving the first fading out as a ghost.
+    manager.noteOn (60, 1.0f);
+    manager.render (left.data(), right.data(), 256, context);
+    manager.noteOn (64, 1.0f);
+    manager.noteOff (64);
+    if (manager.isIdle() || manager.getGhostVoiceCount() == 0)
+    {
+        std::cerr << "Manager reported idle with a releasing voice and a ghost\n";
+        return false;
+    }
+
+    for (int block = 0; block < 64 && ! manager.isIdle(); ++block)
+        manager.render (left.data(), right.data(), 256, context);
+
+    if (! manager.isIdle() || manager.getActiveVoiceCount() != 0 || manager.getGhostVoiceCount() != 0)
+    {
+        std::cerr << "Manager did not return to idle after the release tail\n";
+        return false;
+    }
+
+    std::fill (left.begin(), left.end(), 0.0f);
+    manager.render (left.data(), right.data(), 256, context);
+    if (std::any_of (left.begin(), left.end(), [] (float sample) { return sample != 0.0f; }))
+    {
+        std::cerr << "Idle manager still produced output\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool testParallelRenderDeadlineSkipsVoices()
+{
+    using secretsynth::dsp::mod::Destination;
+    using secretsynth::dsp::mod::ModulationMatrix;
+    using secretsynth::dsp::mod::Source;
+    using secretsynth::dsp::voice::RenderThreadPool;
+
+    VoiceManager manager ({
+        .mode = VoiceManager::Mode::unison,
+        .maxVoices = 32,
+        .unisonVoices = 4,
+        .releaseTimeSeconds = 0.02f,
+    });
+    RenderThreadPool pool (2);
+    manager.prepare (48000.0, 256);
+    manager.setRenderThreadPool (&pool, 0.0);
+
+    ModulationMatrix matrix;
+    matrix.addRoute ({ Source::ampEnv, Destination::amp, 1.0f, false });
+
+    Voice::RenderParameters parameters;
+    parameters.ampEnvelope = { 0.0f, 0.05f, 1.0f, 0.02f };
+    std::vector<float> lfo (256, 0.5f), left (256, 0.0f), right (256, 0.0f);
+    const Voice::RenderContext context { &parameters, &matrix, lfo.data(), lfo.data() };
+
+    for (int note = 48; note < 56; ++note)
+        manager.noteOn (note, 0.8f);
+
+    if (manager.getActiveVoiceCount() < VoiceManager::minimumParallelVoices)
+    {
+        std::cerr << "Deadline test never reached the parallel voice threshold\n";
+        return false;
+    }
+
+    // With a deadline already passed every voice skips its audio, but still keeps time: the
+    // releases run out and the voices go idle as they would have rendering.
+    manager.allNotesOff();
+    for (int block = 0; block < 8; ++block)
+    {
+        manager.render (left.data(), right.data(), 256, context);
+        if (std::any_of (left.begin(), left.end(), [] (float sample) { return sample != 0.0f; }))
+        {
+            std::cerr << "Voices past the render deadline still produced output\n";
+            return false;
+        }
+    }
+
+    if (manager.getActiveVoiceCount() != 0)
+    {
+        std::cerr << "Voices past the render deadline did not finish their release\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool testRenderPathIsRealtimeSafe()
+{
+    using secretsynth::dsp::mod::Destination;
+    using secretsynth::dsp::mod::ModulationMatrix;
+    using secretsynth::dsp::mod::Source;
+    using secretsynth::dsp::voice::RenderThreadPool;
+
+    VoiceManager manager ({
+        .mode = VoiceManager::Mode::unison,
+        .maxVoices = 32,
+        .unisonVoices = 3,
+        .releaseTimeSeconds = 0.02f,
+    });
+    RenderThreadPool pool (2);
+    manager.prepare (48000.0, 256);
+    manager.setRenderThreadPool (&pool);
+    manager.setGovernorConfig ({ .budgetFraction = 0.7f });
+
+    ModulationMatrix matrix;
+    Voice::RenderParameters parameters;
+    std::vector<float> lfo (256, 0.5f), left (256, 0.0f), right (256, 0.0f);
+    const Voice::RenderContext context { &parameters, &matrix, lfo.data(), lfo.data() };
+
+    // Everything a host callback can reach: note events, steals, route edits, parameter changes,
+    // governor reports, config changes and serial and parallel renders.
+    realtime::reset();
+
+    {
+        const realtime::ScopedAudioThread audioThread;
+
+        for (int block = 0; block < 200; ++block)
+        {
+            matrix.clearRoutes();
+            matrix.addRoute ({ Source::ampEnv, Destination::amp, 1.0f, false });
+            matrix.addRoute ({ Source::lfo1, Destination::pdAmount, 0.25f, true });
+
+            parameters.filterCutoffHz = 500.0f + 40.0f * static_cast<float> (block);
+            ++parameters.revision;
+
+            manager.noteOn (36 + (block * 7) % 60, 0.8f);
+            if (block % 3 == 0)
+                manager.noteOff (36 + (block * 5) % 60);
+
+            if (block == 120)
+                manager.setConfig ({ .mode = VoiceManager::Mode::poly, .maxVoices = 8, .releaseTimeSeconds = 0.02f });
+
+            const auto numSamples = block % 4 == 3 ? 32 : 256;
+            if (block % 2 == 0)
+            {
+                const std::array<VoiceManager::RenderSlice, 2> slices { { { numSamples / 2, context }, { numSamples / 2, context } } };
+                manager.render (left.data(), right.data(), slices);
+            }
+            else
+            {
+                manager.render (left.data(), right.data(), numSamples, context);
+            }
+            manager.reportRenderTime (block % 50 == 0 ? 1.0 : 0.0, numSamples);
+        }
+
+        manager.allNotesOff();
+    }
+
+    return realtime::reportViolations ("VoiceManager render path");
+}
 
 int main()
 {
@@ -231,6 +1464,66 @@ int main()
     if (! testLegatoAndUnisonAndPrepareUpdates())
         return 1;
 
+    if (! testRenderFollowsNoteLifecycle())
+        return 1;
+
+    if (! testMidiStormKeepsAllocationConsistentAndFlat())
+        return 1;
+
+    if (! testNoteEventsDoNotAllocateAfterPrepare())
+        return 1;
+
+    if (! testLegatoReturnsThroughHeldStack())
+        return 1;
+
+    if (! testConfigChangesOnlyMoveCapacityWindow())
+        return 1;
+
+    if (! testPerSampleGlideCurves())
+        return 1;
+
+    if (! testInaudibleReleasingVoicesSleepEarly())
+        return 1;
+
+    if (! testGovernorShedsAndRestoresVoices())
+        return 1;
+
+    if (! testGovernorIgnoresSingleSlowBlocks())
+        return 1;
+
+    if (! testStolenVoicesFadeThroughGhosts())
+        return 1;
+
+    if (! testParallelRenderMatchesSerial())
+        return 1;
+
+    if (! testUnisonSpreadPansLanes())
+        return 1;
+
+    if (! testTuningTableDrivesNotePitch())
+        return 1;
+
+    if (! testUnchangedRevisionSkipsParameterSetters())
+        return 1;
+
+    if (! testRenderContextRampsOverrideParameters())
+        return 1;
+
+    if (! testControlBlocksIgnoreRenderSplits())
+        return 1;
+
+    if (! testRestartedVoiceStartsLikeFreshVoice())
+        return 1;
+
+    if (! testIdleTracksReleasesAndGhosts())
+        return 1;
+
+    if (! testParallelRenderDeadlineSkipsVoices())
+        return 1;
+
+    if (! testRenderPathIsRealtimeSafe())
+        return 1;
+
     std::cout << "VoiceManager tests passed\n";
     return 0;
 }
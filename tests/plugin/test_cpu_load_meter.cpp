@@ -0,0 +1,118 @@
+#include "../../src/plugin/telemetry/CpuLoadMeter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+using secretsynth::plugin::telemetry::CpuLoadMeter;
+using secretsynth::plugin::telemetry::Stage;
+using secretsynth::plugin::telemetry::StageSeconds;
+
+namespace
+{
+bool near (double value, double expected)
+{
+    return std::abs (value - expected) < 1.0e-6 * std::max (1.0, std::abs (expected));
+}
+
+int runLoadAndHistogramTest()
+{
+    CpuLoadMeter meter;
+    meter.setSampleRate (48000.0);
+
+    // 480 samples at 48 kHz is a 10 ms budget: 90 blocks at 22 %, 9 at 62 % and one dropout at 152 %.
+    const StageSeconds stages { 0.0002, 0.0015, 0.0003 };
+    for (int block = 0; block < 90; ++block)
+        meter.recordBlock (480, 0.0022, stages);
+    for (int block = 0; block < 9; ++block)
+        meter.recordBlock (480, 0.0062, stages);
+
+    if (! near (meter.recordBlock (480, 0.0152, stages), 1.52))
+    {
+        std::cerr << "Block load is not render time over the real-time budget\n";
+        return 1;
+    }
+
+    const auto snapshot = meter.getSnapshot();
+    if (snapshot.blocks != 100 || snapshot.histogram[CpuLoadMeter::binForLoad (0.22f)] != 90
+        || snapshot.histogram[CpuLoadMeter::binForLoad (0.62f)] != 9 || snapshot.histogram[CpuLoadMeter::binForLoad (1.52f)] != 1)
+    {
+        std::cerr << "Histogram counts do not match the recorded blocks\n";
+        return 1;
+    }
+
+    if (! near (snapshot.peakLoad, 1.52) || ! near (snapshot.lastLoad, 1.52) || ! near (snapshot.getAverageLoad(), (90 * 0.22 + 9 * 0.62 + 1.52) / 100.0)
+        || ! near (snapshot.stageSeconds[static_cast<std::size_t> (Stage::voices)], 0.15))
+    {
+        std::cerr << "Peak, average or stage totals are wrong\n";
+        return 1;
+    }
+
+    if (! near (snapshot.getLoadPercentile (0.5), 0.25) || ! near (snapshot.getLoadPercentile (0.99), 0.65)
+        || ! near (snapshot.getLoadPercentile (1.0), 1.55))
+    {
+        std::cerr << "Percentiles do not follow the histogram\n";
+        return 1;
+    }
+
+    meter.recordBlock (480, 1.0, stages);
+    if (meter.getSnapshot().histogram[CpuLoadMeter::binCount - 1] != 1)
+    {
+        std::cerr << "Loads past the last bin were not clamped into it\n";
+        return 1;
+    }
+
+    meter.reset();
+    const auto cleared = meter.getSnapshot();
+    if (cleared.blocks != 0 || cleared.peakLoad != 0.0f || cleared.getLoadPercentile (0.99) != 0.0f || cleared.renderSeconds != 0.0)
+    {
+        std::cerr << "Reset left data behind\n";
+        return 1;
+    }
+
+    return 0;
+}
+
+int runConcurrentReadTest()
+{
+    // Snapshots taken while the audio thread records never see more blocks than were recorded.
+    CpuLoadMeter meter;
+    constexpr int blocks = 100000;
+    std::thread recorder ([&meter]
+    {
+        for (int block = 0; block < blocks; ++block)
+            meter.recordBlock (64, 0.0005, {});
+    });
+
+    std::uint64_t previous = 0;
+    auto ordered = true;
+    while (previous < blocks)
+    {
+        const auto snapshot = meter.getSnapshot();
+        ordered = ordered && snapshot.blocks >= previous && snapshot.blocks <= blocks;
+        previous = snapshot.blocks;
+    }
+
+    recorder.join();
+
+    if (! ordered || meter.getSnapshot().histogram[CpuLoadMeter::binForLoad (0.0005f * 44100.0f / 64.0f)] != blocks)
+    {
+        std::cerr << "Concurrent snapshots were inconsistent\n";
+        return 1;
+    }
+
+    return 0;
+}
+} // namespace
+
+int main()
+{
+    if (runLoadAndHistogramTest() != 0)
+        return 1;
+
+    if (runConcurrentReadTest() != 0)
+        return 1;
+
+    return 0;
+}
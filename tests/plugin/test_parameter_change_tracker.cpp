@@ -0,0 +1,104 @@
+#include "../../src/plugin/parameters/ParameterChangeTracker.h"
+
+#include <atomic>
+#include <iostream>
+#include <thread>
+
+using secretsynth::plugin::parameters::ParameterChangeTracker;
+using secretsynth::plugin::parameters::ParameterId;
+
+namespace
+{
+int runInitialStateTest()
+{
+    ParameterChangeTracker tracker;
+    const auto initial = tracker.takeChanges();
+
+    for (const auto& spec : secretsynth::plugin::parameters::parameterSpecs)
+    {
+        if (! initial.contains (spec.id))
+        {
+            std::cerr << "Parameter " << spec.stableId << " was not marked initially\n";
+            return 1;
+        }
+    }
+
+    if (tracker.takeChanges().any())
+    {
+        std::cerr << "Taking changes did not clear them\n";
+        return 1;
+    }
+
+    return 0;
+}
+
+int runSelectiveChangeTest()
+{
+    ParameterChangeTracker tracker;
+    (void) tracker.takeChanges();
+
+    tracker.markChanged (ParameterId::filterCutoffHz);
+    tracker.markChanged (ParameterId::performanceVoices);
+    tracker.markChanged (ParameterId::filterCutoffHz);
+
+    const auto changes = tracker.takeChanges();
+    for (const auto& spec : secretsynth::plugin::parameters::parameterSpecs)
+    {
+        const auto expected = spec.id == ParameterId::filterCutoffHz || spec.id == ParameterId::performanceVoices;
+        if (changes.contains (spec.id) != expected)
+        {
+            std::cerr << "Unexpected change state for " << spec.stableId << '\n';
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int runConcurrentMarkTest()
+{
+    // Marks from another thread are never lost, however they interleave with takeChanges.
+    ParameterChangeTracker tracker;
+    (void) tracker.takeChanges();
+
+    constexpr int rounds = 20000;
+    std::atomic<int> marked { 0 };
+    std::thread writer ([&]
+    {
+        for (int round = 0; round < rounds; ++round)
+        {
+            tracker.markChanged (ParameterId::oscillatorTune);
+            marked.fetch_add (1, std::memory_order_release);
+        }
+    });
+
+    auto seen = false;
+    while (marked.load (std::memory_order_acquire) < rounds)
+        seen = tracker.takeChanges().contains (ParameterId::oscillatorTune) || seen;
+
+    writer.join();
+    seen = tracker.takeChanges().contains (ParameterId::oscillatorTune) || seen;
+
+    if (! seen || tracker.takeChanges().any())
+    {
+        std::cerr << "Concurrent marks were lost or left behind\n";
+        return 1;
+    }
+
+    return 0;
+}
+} // namespace
+
+int main()
+{
+    if (runInitialStateTest() != 0)
+        return 1;
+
+    if (runSelectiveChangeTest() != 0)
+        return 1;
+
+    if (runConcurrentMarkTest() != 0)
+        return 1;
+
+    return 0;
+}
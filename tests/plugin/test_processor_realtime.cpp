@@ -0,0 +1,104 @@
+#include "../../src/plugin/PluginProcessor.h"
+#include "../support/RealtimeChecker.h"
+
+#include <array>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+using secretsynth::plugin::SecretSynthAudioProcessor;
+namespace parameters = secretsynth::plugin::parameters;
+namespace realtime = secretsynth::test::realtime;
+
+namespace
+{
+void setParameter (SecretSynthAudioProcessor& processor, parameters::ParameterId id, float value)
+{
+    const juce::String stableId (parameters::getSpec (id).stableId.data());
+    auto& state = processor.getValueTreeState();
+    state.getParameter (stableId)->setValueNotifyingHost (state.getParameterRange (stableId).convertTo0to1 (value));
+}
+
+// Drives processBlock the way a host does: chords, fast notes and parameter automation between
+// blocks, at several block sizes. Everything processBlock does must stay off the allocator and
+// out of mutexes.
+int runProcessBlockTest (double sampleRate, int blockSize)
+{
+    constexpr int blockCount = 400;
+
+    SecretSynthAudioProcessor processor;
+    processor.setPlayConfigDetails (0, 2, sampleRate, blockSize);
+    processor.prepareToPlay (sampleRate, blockSize);
+
+    juce::AudioBuffer<float> buffer (2, blockSize);
+
+    // MIDI buffers allocate as events are added, so every block's events are built up front.
+    std::vector<juce::MidiBuffer> midiBlocks (blockCount);
+    for (int block = 0; block < blockCount; ++block)
+    {
+        auto& midi = midiBlocks[static_cast<std::size_t> (block)];
+        const auto note = 36 + (block * 7) % 48;
+
+        if (block % 16 == 0)
+        {
+            for (const auto offset : { 0, 4, 7, 11 })
+                midi.addEvent (juce::MidiMessage::noteOn (1, note + offset, 0.8f), 0);
+        }
+
+        if (block % 16 == 8)
+        {
+            for (const auto offset : { 0, 4, 7, 11 })
+                midi.addEvent (juce::MidiMessage::noteOff (1, 36 + ((block - 8) * 7) % 48 + offset), blockSize / 2);
+        }
+
+        if (block % 3 == 0)
+            midi.addEvent (juce::MidiMessage::noteOn (1, 84 - block % 24, 1.0f), blockSize / 3);
+
+        if (block % 3 == 1)
+            midi.addEvent (juce::MidiMessage::noteOff (1, 84 - (block - 1) % 24), blockSize - 1);
+
+        if (block == blockCount - 40)
+            midi.addEvent (juce::MidiMessage::allNotesOff (1), 0);
+    }
+
+    realtime::reset();
+
+    for (int block = 0; block < blockCount; ++block)
+    {
+        // Host automation arrives on another thread in a real session; here it lands between blocks.
+        if (block % 10 == 5)
+        {
+            setParameter (processor, parameters::ParameterId::filterCutoffHz, 200.0f + 80.0f * static_cast<float> (block % 50));
+            setParameter (processor, parameters::ParameterId::oscillatorPdAmount, static_cast<float> (block % 20) / 20.0f);
+        }
+
+        if (block == 200)
+            setParameter (processor, parameters::ParameterId::performanceVoices, 4.0f);
+
+        const realtime::ScopedAudioThread audioThread;
+        processor.processBlock (buffer, midiBlocks[static_cast<std::size_t> (block)]);
+    }
+
+    if (! realtime::reportViolations ("processBlock"))
+    {
+        std::cerr << "processBlock is not realtime safe at " << sampleRate << " Hz, " << blockSize << " samples\n";
+        return 1;
+    }
+
+    processor.releaseResources();
+    return 0;
+}
+} // namespace
+
+int main()
+{
+    const juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    for (const auto& [sampleRate, blockSize] : std::array { std::pair { 44100.0, 64 }, std::pair { 48000.0, 512 }, std::pair { 96000.0, 2048 } })
+    {
+        if (runProcessBlockTest (sampleRate, blockSize) != 0)
+            return 1;
+    }
+
+    return 0;
+}
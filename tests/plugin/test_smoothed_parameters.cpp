@@ -0,0 +1,117 @@
+#include "../../src/plugin/parameters/SmoothedParameters.h"
+
+#include <cmath>
+#include <iostream>
+
+using secretsynth::plugin::parameters::ParameterId;
+using secretsynth::plugin::parameters::SmoothedParameters;
+
+namespace
+{
+int runSettledParametersAreConstantTest()
+{
+    SmoothedParameters smoothed;
+    smoothed.prepare (48000.0, 128);
+    smoothed.process (128);
+
+    for (const auto& spec : secretsynth::plugin::parameters::parameterSpecs)
+    {
+        if (smoothed.getRamp (spec.id) != nullptr || smoothed.getValue (spec.id) != spec.defaultValue)
+        {
+            std::cerr << "Parameter " << spec.stableId << " is not settled at its default after prepare\n";
+            return 1;
+        }
+    }
+
+    // Without a ramp time a new target steps straight through.
+    smoothed.setTargetValue (ParameterId::performanceVoices, 4.0f);
+    smoothed.process (128);
+    if (smoothed.getRamp (ParameterId::performanceVoices) != nullptr || smoothed.getValue (ParameterId::performanceVoices) != 4.0f)
+    {
+        std::cerr << "Unsmoothed parameter did not step\n";
+        return 1;
+    }
+
+    return 0;
+}
+
+int runRampSpansBlocksTest()
+{
+    SmoothedParameters smoothed;
+    smoothed.prepare (1000.0, 64);
+    smoothed.setRampTimeSeconds (ParameterId::filterCutoffHz, 0.1f); // 100 samples
+    smoothed.setTargetValue (ParameterId::filterCutoffHz, 1800.0f + 1000.0f);
+
+    auto previous = 1800.0f;
+    for (int block = 0; block < 2; ++block)
+    {
+        smoothed.process (64);
+        const auto* ramp = smoothed.getRamp (ParameterId::filterCutoffHz);
+        if (ramp == nullptr)
+        {
+            std::cerr << "Ramping parameter exposed no buffer in block " << block << '\n';
+            return 1;
+        }
+
+        for (int sample = 0; sample < 64; ++sample)
+        {
+            const auto expectedStep = (block * 64 + sample) < 100 ? 10.0f : 0.0f;
+            if (std::abs (ramp[sample] - previous - expectedStep) > 1.0e-2f)
+            {
+                std::cerr << "Ramp step is not linear at block " << block << " sample " << sample << '\n';
+                return 1;
+            }
+
+            previous = ramp[sample];
+        }
+
+        if (smoothed.getRamp (ParameterId::filterResonance) != nullptr)
+        {
+            std::cerr << "A settled parameter exposed a ramp buffer\n";
+            return 1;
+        }
+    }
+
+    smoothed.process (64);
+    if (smoothed.getRamp (ParameterId::filterCutoffHz) != nullptr || smoothed.getValue (ParameterId::filterCutoffHz) != 2800.0f)
+    {
+        std::cerr << "Ramp did not settle on its target\n";
+        return 1;
+    }
+
+    return 0;
+}
+
+int runFinishRampsTest()
+{
+    SmoothedParameters smoothed;
+    smoothed.prepare (48000.0, 64);
+    smoothed.setRampTimeSeconds (ParameterId::outputGain, 0.05f);
+    smoothed.setTargetValue (ParameterId::outputGain, 0.25f);
+    smoothed.finishRamps();
+    smoothed.process (64);
+
+    if (smoothed.isRamping (ParameterId::outputGain) || smoothed.getRamp (ParameterId::outputGain) != nullptr
+        || smoothed.getValue (ParameterId::outputGain) != 0.25f)
+    {
+        std::cerr << "finishRamps did not jump to the target\n";
+        return 1;
+    }
+
+    return 0;
+}
+} // namespace
+
+int main()
+{
+    if (runSettledParametersAreConstantTest() != 0)
+        return 1;
+
+    if (runRampSpansBlocksTest() != 0)
+        return 1;
+
+    if (runFinishRampsTest() != 0)
+        return 1;
+
+    return 0;
+}
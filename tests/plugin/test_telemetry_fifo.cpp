@@ -0,0 +1,132 @@
+#include "../../src/plugin/telemetry/TelemetryFifo.h"
+
+#include <atomic>
+#include <iostream>
+#include <thread>
+
+using secretsynth::plugin::telemetry::SpscFifo;
+using secretsynth::plugin::telemetry::TelemetryFifo;
+using secretsynth::plugin::telemetry::TelemetryFrame;
+
+namespace
+{
+int runOrderAndCapacityTest()
+{
+    SpscFifo<int, 4> fifo;
+    for (int value = 0; value < 4; ++value)
+    {
+        if (! fifo.push (value))
+        {
+            std::cerr << "Push failed before the FIFO was full\n";
+            return 1;
+        }
+    }
+
+    if (fifo.push (4))
+    {
+        std::cerr << "Push succeeded on a full FIFO\n";
+        return 1;
+    }
+
+    for (int expected = 0; expected < 4; ++expected)
+    {
+        int value = -1;
+        if (! fifo.pop (value) || value != expected)
+        {
+            std::cerr << "Items did not come out in order\n";
+            return 1;
+        }
+    }
+
+    int value = -1;
+    if (fifo.pop (value))
+    {
+        std::cerr << "Pop succeeded on an empty FIFO\n";
+        return 1;
+    }
+
+    return 0;
+}
+
+int runLatestDrainsTest()
+{
+    TelemetryFifo fifo;
+    TelemetryFrame frame;
+    if (fifo.popLatest (frame))
+    {
+        std::cerr << "popLatest succeeded on an empty FIFO\n";
+        return 1;
+    }
+
+    for (int block = 1; block <= 10; ++block)
+        fifo.push ({ .activeVoices = block, .numSamples = 64 });
+
+    if (! fifo.popLatest (frame) || frame.activeVoices != 10 || fifo.pop (frame))
+    {
+        std::cerr << "popLatest did not return the newest frame and drain the rest\n";
+        return 1;
+    }
+
+    return 0;
+}
+
+int runConcurrentTransferTest()
+{
+    // The consumer sees an increasing sequence of whole frames and, once the producer is done, the last one.
+    TelemetryFifo fifo;
+    constexpr int frames = 200000;
+    std::atomic<bool> done { false };
+
+    std::thread producer ([&]
+    {
+        for (int block = 1; block <= frames; ++block)
+        {
+            while (! fifo.push ({ .peakLeft = static_cast<float> (block), .activeVoices = block, .numSamples = -block }))
+                std::this_thread::yield();
+        }
+
+        done.store (true, std::memory_order_release);
+    });
+
+    auto last = 0;
+    auto torn = false;
+    for (auto finished = false; ! finished;)
+    {
+        finished = done.load (std::memory_order_acquire);
+
+        TelemetryFrame frame;
+        const auto gotLatest = (last & 1) != 0 ? fifo.popLatest (frame) : fifo.pop (frame);
+        if (! gotLatest)
+            continue;
+
+        torn = torn || frame.activeVoices <= last || frame.numSamples != -frame.activeVoices
+            || frame.peakLeft != static_cast<float> (frame.activeVoices);
+        last = frame.activeVoices;
+        finished = false;
+    }
+
+    producer.join();
+
+    if (torn || last != frames)
+    {
+        std::cerr << "Frames arrived torn, out of order or incomplete (last " << last << ")\n";
+        return 1;
+    }
+
+    return 0;
+}
+} // namespace
+
+int main()
+{
+    if (runOrderAndCapacityTest() != 0)
+        return 1;
+
+    if (runLatestDrainsTest() != 0)
+        return 1;
+
+    if (runConcurrentTransferTest() != 0)
+        return 1;
+
+    return 0;
+}
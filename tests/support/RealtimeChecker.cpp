@@ -0,0 +1,277 @@
+#include "RealtimeChecker.h"
+
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#if defined(__GLIBC__)
+    #include <dlfcn.h>
+    #include <execinfo.h>
+    #include <pthread.h>
+    #include <unistd.h>
+
+extern "C" void* __libc_malloc (std::size_t size);
+extern "C" void* __libc_calloc (std::size_t count, std::size_t size);
+extern "C" void* __libc_realloc (void* pointer, std::size_t size);
+extern "C" void* __libc_memalign (std::size_t alignment, std::size_t size);
+extern "C" void __libc_free (void* pointer);
+#endif
+
+namespace secretsynth::test::realtime
+{
+namespace
+{
+constexpr int maxFrames = 64;
+
+thread_local int audioScopeDepth = 0;
+
+// Set while the checker itself runs (backtrace() can allocate) so it never counts or recurses.
+thread_local bool insideChecker = false;
+
+std::atomic<std::size_t> allocationCount { 0 };
+std::atomic<std::size_t> deallocationCount { 0 };
+std::atomic<std::size_t> mutexLockCount { 0 };
+std::atomic<Violation> firstViolation { Violation::none };
+std::array<void*, maxFrames> firstFrames {};
+int firstFrameCount = 0;
+
+void record (Violation violation) noexcept
+{
+    if (audioScopeDepth == 0 || insideChecker)
+        return;
+
+    insideChecker = true;
+
+    switch (violation)
+    {
+        case Violation::allocation: allocationCount.fetch_add (1, std::memory_order_relaxed); break;
+        case Violation::deallocation: deallocationCount.fetch_add (1, std::memory_order_relaxed); break;
+        case Violation::mutexLock: mutexLockCount.fetch_add (1, std::memory_order_relaxed); break;
+        case Violation::none: break;
+    }
+
+    auto expected = Violation::none;
+    if (firstViolation.compare_exchange_strong (expected, violation))
+    {
+#if defined(__GLIBC__)
+        firstFrameCount = backtrace (firstFrames.data(), maxFrames);
+#endif
+    }
+
+    insideChecker = false;
+}
+
+const char* describe (Violation violation) noexcept
+{
+    switch (violation)
+    {
+        case Violation::allocation: return "allocation";
+        case Violation::deallocation: return "deallocation";
+        case Violation::mutexLock: return "mutex lock";
+        case Violation::none: break;
+    }
+
+    return "none";
+}
+
+void* allocate (std::size_t size) noexcept
+{
+    record (Violation::allocation);
+#if defined(__GLIBC__)
+    return __libc_malloc (size == 0 ? 1 : size);
+#else
+    return std::malloc (size == 0 ? 1 : size);
+#endif
+}
+
+void* allocateAligned (std::size_t size, std::align_val_t alignment) noexcept
+{
+    record (Violation::allocation);
+    const auto bytes = static_cast<std::size_t> (alignment);
+#if defined(__GLIBC__)
+    return __libc_memalign (bytes, size == 0 ? 1 : size);
+#elif defined(_WIN32)
+    return _aligned_malloc (size == 0 ? 1 : size, bytes);
+#else
+    return std::aligned_alloc (bytes, (size + bytes - 1) / bytes * bytes);
+#endif
+}
+
+void release (void* pointer) noexcept
+{
+    if (pointer == nullptr)
+        return;
+
+    record (Violation::deallocation);
+#if defined(__GLIBC__)
+    __libc_free (pointer);
+#else
+    std::free (pointer);
+#endif
+}
+
+void releaseAligned (void* pointer) noexcept
+{
+    if (pointer == nullptr)
+        return;
+
+    record (Violation::deallocation);
+#if defined(__GLIBC__)
+    __libc_free (pointer);
+#elif defined(_WIN32)
+    _aligned_free (pointer);
+#else
+    std::free (pointer);
+#endif
+}
+
+void* allocateOrThrow (std::size_t size)
+{
+    if (auto* pointer = allocate (size))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+void* allocateAlignedOrThrow (std::size_t size, std::align_val_t alignment)
+{
+    if (auto* pointer = allocateAligned (size, alignment))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+#if defined(__GLIBC__)
+using MutexLockFunction = int (*) (pthread_mutex_t*);
+
+std::atomic<MutexLockFunction> realMutexLock { nullptr };
+
+MutexLockFunction getRealMutexLock() noexcept
+{
+    auto function = realMutexLock.load (std::memory_order_acquire);
+    if (function == nullptr)
+    {
+        function = reinterpret_cast<MutexLockFunction> (dlsym (RTLD_NEXT, "pthread_mutex_lock"));
+        realMutexLock.store (function, std::memory_order_release);
+    }
+
+    return function;
+}
+
+// Resolves the real lock and loads the unwinder before any test opens a scope, so neither
+// happens for the first time inside one.
+const auto primed = []
+{
+    std::array<void*, 1> frame {};
+    backtrace (frame.data(), static_cast<int> (frame.size()));
+    return getRealMutexLock() != nullptr;
+}();
+#endif
+} // namespace
+
+ScopedAudioThread::ScopedAudioThread() noexcept
+{
+    ++audioScopeDepth;
+}
+
+ScopedAudioThread::~ScopedAudioThread()
+{
+    --audioScopeDepth;
+}
+
+Counts getCounts() noexcept
+{
+    return { allocationCount.load(), deallocationCount.load(), mutexLockCount.load() };
+}
+
+Violation getFirstViolation() noexcept
+{
+    return firstViolation.load();
+}
+
+void reset() noexcept
+{
+    allocationCount.store (0);
+    deallocationCount.store (0);
+    mutexLockCount.store (0);
+    firstFrameCount = 0;
+    firstViolation.store (Violation::none);
+}
+
+bool reportViolations (const char* label)
+{
+    const auto counts = getCounts();
+    if (counts.total() == 0)
+        return true;
+
+    std::fprintf (stderr, "%s is not realtime safe: %zu allocations, %zu deallocations, %zu mutex locks\n", label,
+                  counts.allocations, counts.deallocations, counts.mutexLocks);
+    std::fprintf (stderr, "First violation (%s):\n", describe (getFirstViolation()));
+    std::fflush (stderr);
+
+#if defined(__GLIBC__)
+    backtrace_symbols_fd (firstFrames.data(), firstFrameCount, STDERR_FILENO);
+#endif
+
+    return false;
+}
+} // namespace secretsynth::test::realtime
+
+namespace realtime = secretsynth::test::realtime;
+
+void* operator new (std::size_t size) { return realtime::allocateOrThrow (size); }
+void* operator new[] (std::size_t size) { return realtime::allocateOrThrow (size); }
+void* operator new (std::size_t size, const std::nothrow_t&) noexcept { return realtime::allocate (size); }
+void* operator new[] (std::size_t size, const std::nothrow_t&) noexcept { return realtime::allocate (size); }
+void* operator new (std::size_t size, std::align_val_t alignment) { return realtime::allocateAlignedOrThrow (size, alignment); }
+void* operator new[] (std::size_t size, std::align_val_t alignment) { return realtime::allocateAlignedOrThrow (size, alignment); }
+
+void operator delete (void* pointer) noexcept { realtime::release (pointer); }
+void operator delete[] (void* pointer) noexcept { realtime::release (pointer); }
+void operator delete (void* pointer, std::size_t) noexcept { realtime::release (pointer); }
+void operator delete[] (void* pointer, std::size_t) noexcept { realtime::release (pointer); }
+void operator delete (void* pointer, const std::nothrow_t&) noexcept { realtime::release (pointer); }
+void operator delete[] (void* pointer, const std::nothrow_t&) noexcept { realtime::release (pointer); }
+void operator delete (void* pointer, std::align_val_t) noexcept { realtime::releaseAligned (pointer); }
+void operator delete[] (void* pointer, std::align_val_t) noexcept { realtime::releaseAligned (pointer); }
+void operator delete (void* pointer, std::size_t, std::align_val_t) noexcept { realtime::releaseAligned (pointer); }
+void operator delete[] (void* pointer, std::size_t, std::align_val_t) noexcept { realtime::releaseAligned (pointer); }
+
+#if defined(__GLIBC__)
+extern "C"
+{
+void* malloc (std::size_t size) noexcept
+{
+    realtime::record (realtime::Violation::allocation);
+    return __libc_malloc (size);
+}
+
+void* calloc (std::size_t count, std::size_t size) noexcept
+{
+    realtime::record (realtime::Violation::allocation);
+    return __libc_calloc (count, size);
+}
+
+void* realloc (void* pointer, std::size_t size) noexcept
+{
+    realtime::record (realtime::Violation::allocation);
+    return __libc_realloc (pointer, size);
+}
+
+void free (void* pointer) noexcept
+{
+    if (pointer != nullptr)
+        realtime::record (realtime::Violation::deallocation);
+
+    __libc_free (pointer);
+}
+
+int pthread_mutex_lock (pthread_mutex_t* mutex) noexcept
+{
+    realtime::record (realtime::Violation::mutexLock);
+    return realtime::getRealMutexLock() (mutex);
+}
+}
+#endif
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+
+namespace secretsynth::test::realtime
+{
+// Test support that catches audio-thread code allocating or locking. Linking RealtimeChecker.cpp
+// into a test replaces operator new/delete and, on glibc, malloc/calloc/realloc/free and
+// pthread_mutex_lock with versions that count every call made while a ScopedAudioThread is alive
+// on the calling thread, and record the backtrace of the first one.
+enum class Violation
+{
+    none,
+    allocation,
+    deallocation,
+    mutexLock
+};
+
+struct Counts
+{
+    std::size_t allocations { 0 };
+    std::size_t deallocations { 0 };
+    std::size_t mutexLocks { 0 };
+
+    [[nodiscard]] std::size_t total() const noexcept { return allocations + deallocations + mutexLocks; }
+};
+
+// Marks the calling thread as the audio thread until destroyed. Scopes nest.
+class ScopedAudioThread
+{
+public:
+    ScopedAudioThread() noexcept;
+    ~ScopedAudioThread();
+
+    ScopedAudioThread (const ScopedAudioThread&) = delete;
+    ScopedAudioThread& operator= (const ScopedAudioThread&) = delete;
+};
+
+[[nodiscard]] Counts getCounts() noexcept;
+[[nodiscard]] Violation getFirstViolation() noexcept;
+
+// Clears the counts and the recorded backtrace.
+void reset() noexcept;
+
+// Returns true if nothing was counted since the last reset(); otherwise prints the counts and the
+// first violation's backtrace to stderr, prefixed with label, and returns false.
+bool reportViolations (const char* label);
+} // namespace secretsynth::test::realtime
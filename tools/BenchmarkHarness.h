@@ -0,0 +1,222 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace secretsynth::tools
+{
+// Shared harness for the benchmark executables: each case runs warmup repetitions, then timed
+// repetitions whose per-repetition times are summarised as median/p99 and per-item costs, and
+// the whole run is written as JSON so results from two builds can be diffed.
+struct BenchmarkSettings
+{
+    int warmupRepetitions { 5 };
+    int repetitions { 50 };
+    std::string filter; // only cases whose "group/name" contains this run
+};
+
+struct BenchmarkResult
+{
+    std::string group;
+    std::string name;
+    std::string unit; // what one item is: "sample", "event", "evaluation"...
+    double itemsPerRepetition { 0.0 };
+    double medianNs { 0.0 };
+    double p99Ns { 0.0 };
+    double minNs { 0.0 };
+    double maxNs { 0.0 };
+    double meanNs { 0.0 };
+
+    // Case-specific figures written alongside the timings, e.g. a real-time factor.
+    std::vector<std::pair<std::string, double>> metrics;
+
+    [[nodiscard]] double medianNsPerItem() const noexcept { return medianNs / itemsPerRepetition; }
+    [[nodiscard]] double p99NsPerItem() const noexcept { return p99Ns / itemsPerRepetition; }
+};
+
+inline volatile float benchmarkSink = 0.0f;
+
+// Keeps a computed value alive so the optimiser cannot drop the work that produced it.
+inline void doNotOptimize (float value) noexcept
+{
+    benchmarkSink = value;
+}
+
+// Nearest-rank percentile of already sorted values; fraction in [0, 1].
+inline double percentile (const std::vector<double>& sorted, double fraction) noexcept
+{
+    if (sorted.empty())
+        return 0.0;
+
+    const auto rank = static_cast<std::size_t> (std::ceil (fraction * static_cast<double> (sorted.size())));
+    return sorted[std::clamp<std::size_t> (rank, 1, sorted.size()) - 1];
+}
+
+inline BenchmarkResult summarise (std::string group, std::string name, std::string unit, double itemsPerRepetition, std::vector<double> timesNs)
+{
+    std::sort (timesNs.begin(), timesNs.end());
+
+    BenchmarkResult result;
+    result.group = std::move (group);
+    result.name = std::move (name);
+    result.unit = std::move (unit);
+    result.itemsPerRepetition = itemsPerRepetition;
+    if (timesNs.empty())
+        return result;
+
+    auto total = 0.0;
+    for (const auto time : timesNs)
+        total += time;
+
+    result.medianNs = percentile (timesNs, 0.5);
+    result.p99Ns = percentile (timesNs, 0.99);
+    result.minNs = timesNs.front();
+    result.maxNs = timesNs.back();
+    result.meanNs = total / static_cast<double> (timesNs.size());
+    return result;
+}
+
+[[nodiscard]] inline bool matchesFilter (const BenchmarkSettings& settings, std::string_view group, std::string_view name)
+{
+    return settings.filter.empty() || (std::string (group) + "/" + std::string (name)).find (settings.filter) != std::string::npos;
+}
+
+// Times repetition() once per repetition after the warmup and appends the summary to results.
+// Each call of repetition must process itemsPerRepetition items.
+template <typename Repetition>
+void runBenchmark (std::vector<BenchmarkResult>& results,
+                   const BenchmarkSettings& settings,
+                   std::string group,
+                   std::string name,
+                   std::string unit,
+                   double itemsPerRepetition,
+                   Repetition&& repetition)
+{
+    using Clock = std::chrono::steady_clock;
+
+    if (! matchesFilter (settings, group, name))
+        return;
+
+    for (int warmup = 0; warmup < settings.warmupRepetitions; ++warmup)
+        repetition();
+
+    std::vector<double> timesNs;
+    timesNs.reserve (static_cast<std::size_t> (std::max (0, settings.repetitions)));
+    for (int index = 0; index < settings.repetitions; ++index)
+    {
+        const auto start = Clock::now();
+        repetition();
+        const auto end = Clock::now();
+        timesNs.push_back (static_cast<double> (std::chrono::duration_cast<std::chrono::nanoseconds> (end - start).count()));
+    }
+
+    results.push_back (summarise (std::move (group), std::move (name), std::move (unit), itemsPerRepetition, std::move (timesNs)));
+}
+
+// Parses --warmup=N, --repetitions=N and --filter=TEXT; returns the remaining arguments.
+inline std::vector<std::string> parseBenchmarkArguments (int argc, char** argv, BenchmarkSettings& settings)
+{
+    std::vector<std::string> remaining;
+    for (int index = 1; index < argc; ++index)
+    {
+        const std::string_view argument (argv[index]);
+        const auto value = [&] (std::string_view prefix) { return std::string (argument.substr (prefix.size())); };
+
+        if (argument.starts_with ("--warmup="))
+            settings.warmupRepetitions = std::max (0, std::stoi (value ("--warmup=")));
+        else if (argument.starts_with ("--repetitions="))
+            settings.repetitions = std::max (1, std::stoi (value ("--repetitions=")));
+        else if (argument.starts_with ("--filter="))
+            settings.filter = value ("--filter=");
+        else
+            remaining.emplace_back (argument);
+    }
+
+    return remaining;
+}
+
+inline void writeJsonString (std::ostream& stream, std::string_view text)
+{
+    stream << '"';
+    for (const auto character : text)
+    {
+        if (character == '"' || character == '\\')
+            stream << '\\';
+
+        stream << character;
+    }
+    stream << '"';
+}
+
+// Writes { "schemaVersion", "compiler", "settings", "context", "benchmarks": [...] }. context holds
+// run-wide values such as the sample rate.
+inline void writeJson (std::ostream& stream,
+                       const BenchmarkSettings& settings,
+                       const std::vector<std::pair<std::string, double>>& context,
+                       const std::vector<BenchmarkResult>& results)
+{
+    // One "key": value line per entry; followedByMore keeps a comma after the last one.
+    const auto writeNumbers = [&stream] (const std::vector<std::pair<std::string, double>>& values, const char* indent, bool followedByMore)
+    {
+        for (std::size_t index = 0; index < values.size(); ++index)
+        {
+            stream << indent;
+            writeJsonString (stream, values[index].first);
+            stream << ": " << values[index].second << (index + 1 < values.size() || followedByMore ? ",\n" : "\n");
+        }
+    };
+
+    stream << std::setprecision (10) << "{\n  \"schemaVersion\": 1,\n  \"compiler\": ";
+#if defined(__VERSION__)
+    writeJsonString (stream, __VERSION__);
+#else
+    writeJsonString (stream, "unknown");
+#endif
+    stream << ",\n  \"settings\": { \"warmupRepetitions\": " << settings.warmupRepetitions << ", \"repetitions\": " << settings.repetitions
+           << " },\n  \"context\": {\n";
+    writeNumbers (context, "    ", false);
+    stream << "  },\n  \"benchmarks\": [\n";
+
+    for (std::size_t index = 0; index < results.size(); ++index)
+    {
+        const auto& result = results[index];
+        stream << "    {\n      \"group\": ";
+        writeJsonString (stream, result.group);
+        stream << ",\n      \"name\": ";
+        writeJsonString (stream, result.name);
+        stream << ",\n      \"unit\": ";
+        writeJsonString (stream, result.unit);
+        stream << ",\n";
+
+        writeNumbers ({ { "itemsPerRepetition", result.itemsPerRepetition },
+                        { "medianNs", result.medianNs },
+                        { "p99Ns", result.p99Ns },
+                        { "minNs", result.minNs },
+                        { "maxNs", result.maxNs },
+                        { "meanNs", result.meanNs },
+                        { "medianNsPerItem", result.medianNsPerItem() },
+                        { "p99NsPerItem", result.p99NsPerItem() } },
+                      "      ",
+                      ! result.metrics.empty());
+
+        if (! result.metrics.empty())
+        {
+            stream << "      \"metrics\": {\n";
+            writeNumbers (result.metrics, "        ", false);
+            stream << "      }\n";
+        }
+
+        stream << "    }" << (index + 1 < results.size() ? ",\n" : "\n");
+    }
+
+    stream << "  ]\n}\n";
+}
+} // namespace secretsynth::tools
@@ -0,0 +1,325 @@
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "BenchmarkHarness.h"
+#include "../src/dsp/filter/MultiModeFilter.h"
+#include "../src/dsp/mod/Modulation.h"
+#include "../src/dsp/osc/PhaseWarpOscillator.h"
+#include "../src/dsp/voice/VoiceManager.h"
+
+// Micro-benchmarks for the DSP building blocks. Every case processes the same amount of work per
+// repetition and reports median/p99 time and cost per item; the results are written as JSON to
+// the path given on the command line, or to stdout.
+//
+//   secretsynth_dsp_benchmarks [--warmup=N] [--repetitions=N] [--filter=TEXT] [output.json]
+
+namespace
+{
+using secretsynth::tools::BenchmarkResult;
+using secretsynth::tools::BenchmarkSettings;
+using secretsynth::tools::doNotOptimize;
+using secretsynth::tools::runBenchmark;
+
+constexpr double sampleRate = 48000.0;
+constexpr int blockSize = 256;
+constexpr int blocksPerRepetition = 64;
+constexpr int samplesPerRepetition = blockSize * blocksPerRepetition;
+constexpr int controlBlockSize = secretsynth::dsp::voice::Voice::controlBlockSize;
+constexpr int controlBlocksPerRepetition = samplesPerRepetition / controlBlockSize;
+
+void benchmarkOscillator (std::vector<BenchmarkResult>& results, const BenchmarkSettings& settings)
+{
+    using Osc = secretsynth::dsp::osc::PhaseWarpOscillator;
+
+    for (const auto& [modeName, mode] : { std::pair { "low", Osc::QualityMode::low },
+                                          std::pair { "medium", Osc::QualityMode::medium },
+                                          std::pair { "high", Osc::QualityMode::high } })
+    {
+        for (const auto lanes : { 1, 4 })
+        {
+            Osc osc;
+            osc.prepare (sampleRate);
+            osc.setPdAmount (0.7f);
+            osc.setPdShape (0.35f);
+            osc.setQualityMode (mode);
+
+            std::vector<float> frequency (blockSize);
+            for (int i = 0; i < blockSize; ++i)
+                frequency[static_cast<std::size_t> (i)] = 220.0f * (1.0f + 0.01f * std::sin (static_cast<float> (i) * 0.05f));
+
+            const std::array<float, 4> ratios { 1.0f, 1.004f, 0.996f, 1.008f };
+            std::array<float, 4> phases {};
+            std::vector<float> output (static_cast<std::size_t> (lanes * blockSize));
+
+            runBenchmark (results, settings, "oscillator", std::string (modeName) + "/lanes=" + std::to_string (lanes), "sample",
+                          static_cast<double> (samplesPerRepetition) * lanes,
+                          [&]
+                          {
+                              for (int block = 0; block < blocksPerRepetition; ++block)
+                              {
+                                  osc.renderLanes (frequency.data(), ratios.data(), phases.data(), output.data(), blockSize, lanes, blockSize);
+                                  doNotOptimize (output[0]);
+                              }
+                          });
+        }
+    }
+}
+
+void benchmarkFilter (std::vector<BenchmarkResult>& results, const BenchmarkSettings& settings)
+{
+    using Filter = secretsynth::dsp::filter::MultiModeFilter;
+
+    std::vector<float> input (blockSize);
+    std::uint32_t seed = 1u;
+    for (auto& sample : input)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        sample = static_cast<float> (seed >> 8) / static_cast<float> (1u << 24) * 2.0f - 1.0f;
+    }
+
+    const auto cutoffAt = [] (int controlBlock) { return 400.0f + 3600.0f * (0.5f + 0.5f * std::sin (static_cast<float> (controlBlock) * 0.02f)); };
+
+    for (const auto& [modeName, mode] : { std::pair { "lowPass", Filter::Mode::lowPass },
+                                          std::pair { "bandPass", Filter::Mode::bandPass },
+                                          std::pair { "highPass", Filter::Mode::highPass } })
+    {
+        Filter filter;
+        filter.prepare (sampleRate);
+        filter.setMode (mode);
+        filter.setCutoffHz (1200.0f);
+        filter.setResonance (0.6f);
+        std::vector<float> samples (blockSize);
+
+        // Fixed cutoff: coefficients computed once, the block loop only runs the state update.
+        const auto coefficients = filter.computeCoefficients (220.0f);
+        runBenchmark (results, settings, "filter", std::string (modeName) + "/static", "sample", samplesPerRepetition,
+                      [&]
+                      {
+                          for (int block = 0; block < blocksPerRepetition; ++block)
+                          {
+                              samples = input;
+                              filter.processBlock (samples.data(), blockSize, coefficients);
+                              doNotOptimize (samples[0]);
+                          }
+                      });
+
+        // Modulated at control rate, the way voices run it: new coefficients every control block.
+        runBenchmark (results, settings, "filter", std::string (modeName) + "/controlRateCutoff", "sample", samplesPerRepetition,
+                      [&]
+                      {
+                          for (int block = 0; block < blocksPerRepetition; ++block)
+                          {
+                              samples = input;
+                              for (int start = 0; start < blockSize; start += controlBlockSize)
+                              {
+                                  filter.setCutoffHz (cutoffAt (block * blockSize + start));
+                                  filter.processBlock (samples.data() + start, controlBlockSize, filter.computeCoefficients (220.0f));
+                              }
+                              doNotOptimize (samples[0]);
+                          }
+                      });
+
+        // Modulated every sample: the worst case if cutoff were driven at audio rate.
+        runBenchmark (results, settings, "filter", std::string (modeName) + "/audioRateCutoff", "sample", samplesPerRepetition,
+                      [&]
+                      {
+                          auto sum = 0.0f;
+                          for (int block = 0; block < blocksPerRepetition; ++block)
+                          {
+                              for (int i = 0; i < blockSize; ++i)
+                              {
+                                  filter.setCutoffHz (cutoffAt (block * blockSize + i));
+                                  sum += filter.processSample (input[static_cast<std::size_t> (i)], 220.0f);
+                              }
+                          }
+                          doNotOptimize (sum);
+                      });
+    }
+}
+
+void benchmarkModulationSources (std::vector<BenchmarkResult>& results, const BenchmarkSettings& settings)
+{
+    using secretsynth::dsp::mod::AdsrEnvelope;
+    using secretsynth::dsp::mod::Lfo;
+
+    AdsrEnvelope envelope;
+    envelope.setSampleRate (sampleRate);
+    envelope.setParameters ({ 0.005f, 0.05f, 0.6f, 0.1f });
+
+    // Gates cycle every 4096 samples so attack, decay, sustain and release are all timed.
+    const auto gate = [&envelope] (int sample)
+    {
+        if (sample % 4096 == 0)
+            envelope.noteOn();
+        else if (sample % 4096 == 2048)
+            envelope.noteOff();
+    };
+
+    runBenchmark (results, settings, "envelope", "adsr/perSample", "sample", samplesPerRepetition,
+                  [&]
+                  {
+                      auto sum = 0.0f;
+                      for (int sample = 0; sample < samplesPerRepetition; ++sample)
+                      {
+                          gate (sample);
+                          sum += envelope.processSample();
+                      }
+                      doNotOptimize (sum);
+                  });
+
+    runBenchmark (results, settings, "envelope", "adsr/controlRate", "sample", samplesPerRepetition,
+                  [&]
+                  {
+                      auto sum = 0.0f;
+                      for (int sample = 0; sample < samplesPerRepetition; sample += controlBlockSize)
+                      {
+                          gate (sample);
+                          sum += envelope.advance (controlBlockSize);
+                      }
+                      doNotOptimize (sum);
+                  });
+
+    for (const auto& [waveformName, waveform] : { std::pair { "sine", Lfo::Waveform::sine }, std::pair { "triangle", Lfo::Waveform::triangle } })
+    {
+        Lfo lfo;
+        lfo.setSampleRate (sampleRate);
+        lfo.setWaveform (waveform);
+        lfo.setRateHz (5.0f);
+
+        runBenchmark (results, settings, "lfo", std::string (waveformName) + "/perSample", "sample", samplesPerRepetition,
+                      [&]
+                      {
+                          auto sum = 0.0f;
+                          for (int sample = 0; sample < samplesPerRepetition; ++sample)
+                              sum += lfo.processSample();
+                          doNotOptimize (sum);
+                      });
+
+        runBenchmark (results, settings, "lfo", std::string (waveformName) + "/controlRate", "sample", samplesPerRepetition,
+                      [&]
+                      {
+                          auto sum = 0.0f;
+                          for (int sample = 0; sample < samplesPerRepetition; sample += controlBlockSize)
+                              sum += lfo.advance (controlBlockSize);
+                          doNotOptimize (sum);
+                      });
+    }
+}
+
+void benchmarkModulationMatrix (std::vector<BenchmarkResult>& results, const BenchmarkSettings& settings)
+{
+    using secretsynth::dsp::mod::Destination;
+    using secretsynth::dsp::mod::ModulationMatrix;
+    using secretsynth::dsp::mod::Source;
+
+    constexpr auto sourceCount = static_cast<std::size_t> (Source::count);
+    constexpr auto destinationCount = static_cast<std::size_t> (Destination::count);
+
+    for (const auto routeCount : { 0, 1, 2, 4, 8, 16, 32 })
+    {
+        ModulationMatrix matrix;
+        matrix.setSampleRate (sampleRate / controlBlockSize);
+        for (int route = 0; route < routeCount; ++route)
+        {
+            const auto index = static_cast<std::size_t> (route);
+            matrix.addRoute ({ static_cast<Source> (index % sourceCount), static_cast<Destination> (index % destinationCount), 0.1f, index % 2 == 0 });
+        }
+
+        std::array<float, sourceCount> sources {};
+        runBenchmark (results, settings, "modulationMatrix", "routes=" + std::to_string (routeCount), "evaluation", controlBlocksPerRepetition,
+                      [&]
+                      {
+                          auto sum = 0.0f;
+                          for (int block = 0; block < controlBlocksPerRepetition; ++block)
+                          {
+                              sources[static_cast<std::size_t> (block) % sourceCount] = static_cast<float> (block % 97) / 97.0f;
+                              sum += matrix.process (sources)[0];
+                          }
+                          doNotOptimize (sum);
+                      });
+    }
+}
+
+void benchmarkVoiceManagerEvents (std::vector<BenchmarkResult>& results, const BenchmarkSettings& settings)
+{
+    using secretsynth::dsp::voice::VoiceManager;
+
+    constexpr int eventsPerRepetition = 20000;
+
+    for (const auto& [modeName, mode] : { std::pair { "poly", VoiceManager::Mode::poly },
+                                          std::pair { "mono", VoiceManager::Mode::mono },
+                                          std::pair { "unison", VoiceManager::Mode::unison } })
+    {
+        for (const auto maxVoices : { std::size_t { 16 }, std::size_t { 64 } })
+        {
+            VoiceManager manager ({ .mode = mode, .maxVoices = maxVoices, .unisonVoices = 4, .releaseTimeSeconds = 0.05f });
+            manager.prepare (sampleRate, blockSize, maxVoices);
+
+            // A seeded note-on/note-off storm with occasional time advances, so steals, releases and
+            // retriggers all appear in the mix.
+            std::uint32_t seed = 7u;
+            runBenchmark (results, settings, "voiceManager", std::string (modeName) + "/voices=" + std::to_string (maxVoices), "event",
+                          eventsPerRepetition,
+                          [&]
+                          {
+                              for (int event = 0; event < eventsPerRepetition; ++event)
+                              {
+                                  seed = seed * 1664525u + 1013904223u;
+                                  const auto note = static_cast<int> ((seed >> 8) % 128u);
+                                  if ((seed >> 20) % 3u != 0u)
+                                      manager.noteOn (note, 0.8f);
+                                  else
+                                      manager.noteOff (note);
+
+                                  if (event % 64 == 0)
+                                      manager.advance (controlBlockSize);
+                              }
+
+                              manager.allNotesOff();
+                          });
+        }
+    }
+}
+} // namespace
+
+int main (int argc, char** argv)
+{
+    BenchmarkSettings settings;
+    const auto arguments = secretsynth::tools::parseBenchmarkArguments (argc, argv, settings);
+
+    std::vector<BenchmarkResult> results;
+    benchmarkOscillator (results, settings);
+    benchmarkFilter (results, settings);
+    benchmarkModulationSources (results, settings);
+    benchmarkModulationMatrix (results, settings);
+    benchmarkVoiceManagerEvents (results, settings);
+
+    const std::vector<std::pair<std::string, double>> context {
+        { "sampleRate", sampleRate },
+        { "blockSize", blockSize },
+        { "controlBlockSize", controlBlockSize },
+        { "samplesPerRepetition", samplesPerRepetition },
+    };
+
+    if (arguments.empty())
+    {
+        secretsynth::tools::writeJson (std::cout, settings, context, results);
+        return 0;
+    }
+
+    std::ofstream output (arguments.front());
+    if (! output)
+    {
+        std::cerr << "Cannot write " << arguments.front() << '\n';
+        return 1;
+    }
+
+    secretsynth::tools::writeJson (output, settings, context, results);
+    std::cerr << "Wrote " << results.size() << " benchmarks to " << arguments.front() << '\n';
+    return 0;
+}
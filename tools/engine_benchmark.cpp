@@ -0,0 +1,275 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "BenchmarkHarness.h"
+#include "../src/plugin/PluginProcessor.h"
+
+// End-to-end engine benchmark: the plugin's processor is instantiated without a host or editor
+// and driven through processBlock with synthetic MIDI, across sample rates and block sizes.
+// Per case it reports real-time factor, CPU% of one core per instance and the worst block's time
+// against its budget; the JSON goes to the path given on the command line, or to stdout.
+//
+//   secretsynth_engine_benchmark [--seconds=N] [--warmup=N] [--repetitions=N] [--filter=TEXT] [output.json]
+
+namespace
+{
+using secretsynth::plugin::SecretSynthAudioProcessor;
+using secretsynth::tools::BenchmarkResult;
+using secretsynth::tools::BenchmarkSettings;
+namespace parameters = secretsynth::plugin::parameters;
+
+// The start of every pass is rendered but not timed, so first-touch costs stay out of the numbers.
+constexpr double untimedSecondsPerPass = 0.25;
+
+enum class Pattern
+{
+    blockChords,
+    fastArpeggio,
+    sustainedPad,
+    midiStorm
+};
+
+constexpr std::array patterns {
+    std::pair { "blockChords", Pattern::blockChords },
+    std::pair { "fastArpeggio", Pattern::fastArpeggio },
+    std::pair { "sustainedPad", Pattern::sustainedPad },
+    std::pair { "midiStorm", Pattern::midiStorm },
+};
+
+constexpr std::array sampleRates { 44100.0, 48000.0, 96000.0 };
+constexpr std::array blockSizes { 16, 32, 64, 128, 256, 512, 1024, 2048 };
+
+struct NoteEvent
+{
+    double timeSeconds { 0.0 };
+    int note { 60 };
+    bool on { true };
+};
+
+std::vector<NoteEvent> makeEvents (Pattern pattern, double durationSeconds)
+{
+    std::vector<NoteEvent> events;
+    constexpr std::array chordShape { 0, 4, 7, 11 };
+    constexpr std::array chordRoots { 48, 53, 45, 50 };
+
+    switch (pattern)
+    {
+        case Pattern::blockChords:
+        {
+            // Four-note chords every half second, each released as the next one starts.
+            auto chord = 0;
+            for (auto time = 0.0; time < durationSeconds; time += 0.5, ++chord)
+            {
+                const auto root = chordRoots[static_cast<std::size_t> (chord) % chordRoots.size()];
+                const auto previousRoot = chordRoots[static_cast<std::size_t> (chord + 3) % chordRoots.size()];
+                for (const auto interval : chordShape)
+                {
+                    if (chord > 0)
+                        events.push_back ({ time, previousRoot + interval, false });
+
+                    events.push_back ({ time, root + interval, true });
+                }
+            }
+            break;
+        }
+
+        case Pattern::fastArpeggio:
+        {
+            // Sixteenth notes at 150 bpm over three octaves, each held for 80% of its step.
+            constexpr double step = 60.0 / 150.0 / 4.0;
+            auto index = 0;
+            for (auto time = 0.0; time < durationSeconds; time += step, ++index)
+            {
+                const auto note = 48 + 12 * ((index / 4) % 3) + chordShape[static_cast<std::size_t> (index) % chordShape.size()];
+                events.push_back ({ time, note, true });
+                events.push_back ({ time + 0.8 * step, note, false });
+            }
+            break;
+        }
+
+        case Pattern::sustainedPad:
+        {
+            // Sixteen voices held for the whole run.
+            for (int voice = 0; voice < 16; ++voice)
+                events.push_back ({ 0.0, 36 + voice * 3, true });
+            break;
+        }
+
+        case Pattern::midiStorm:
+        {
+            // 2000 events per second on seeded random keys, two thirds of them note-ons.
+            std::uint32_t seed = 12345u;
+            for (auto time = 0.0; time < durationSeconds; time += 0.0005)
+            {
+                seed = seed * 1664525u + 1013904223u;
+                events.push_back ({ time, static_cast<int> ((seed >> 8) % 128u), (seed >> 20) % 3u != 0u });
+            }
+            break;
+        }
+    }
+
+    std::stable_sort (events.begin(), events.end(), [] (const auto& a, const auto& b) { return a.timeSeconds < b.timeSeconds; });
+    return events;
+}
+
+void setParameter (SecretSynthAudioProcessor& processor, parameters::ParameterId id, float value)
+{
+    const juce::String stableId (parameters::getSpec (id).stableId.data());
+    auto& state = processor.getValueTreeState();
+    state.getParameter (stableId)->setValueNotifyingHost (state.getParameterRange (stableId).convertTo0to1 (value));
+}
+
+BenchmarkResult runCase (const char* patternName,
+                         std::string name,
+                         Pattern pattern,
+                         double sampleRate,
+                         int blockSize,
+                         double secondsPerPass,
+                         const BenchmarkSettings& settings)
+{
+    using Clock = std::chrono::steady_clock;
+
+    const auto passSeconds = untimedSecondsPerPass + secondsPerPass;
+    const auto blocksPerPass = static_cast<int> (std::ceil (passSeconds * sampleRate / blockSize));
+    const auto untimedBlocks = static_cast<int> (std::ceil (untimedSecondsPerPass * sampleRate / blockSize));
+
+    // Every block's MIDI is built before rendering starts; filling a MidiBuffer allocates.
+    std::vector<juce::MidiBuffer> midiBlocks (static_cast<std::size_t> (blocksPerPass));
+    for (const auto& event : makeEvents (pattern, passSeconds))
+    {
+        const auto samplePosition = static_cast<std::int64_t> (std::llround (event.timeSeconds * sampleRate));
+        const auto block = static_cast<std::size_t> (samplePosition / blockSize);
+        if (block >= midiBlocks.size())
+            continue;
+
+        const auto message = event.on ? juce::MidiMessage::noteOn (1, event.note, 0.8f) : juce::MidiMessage::noteOff (1, event.note);
+        midiBlocks[block].addEvent (message, static_cast<int> (samplePosition % blockSize));
+    }
+
+    SecretSynthAudioProcessor processor;
+    processor.setPlayConfigDetails (0, 2, sampleRate, blockSize);
+    setParameter (processor, parameters::ParameterId::performanceVoices, 16.0f);
+
+    juce::AudioBuffer<float> buffer (2, blockSize);
+    std::vector<double> blockTimesNs;
+    blockTimesNs.reserve (static_cast<std::size_t> (settings.repetitions * (blocksPerPass - untimedBlocks)));
+    auto timedSeconds = 0.0;
+    auto peakVoices = 0;
+
+    for (int pass = 0; pass < settings.warmupRepetitions + settings.repetitions; ++pass)
+    {
+        const auto timed = pass >= settings.warmupRepetitions;
+        processor.prepareToPlay (sampleRate, blockSize);
+
+        for (int block = 0; block < blocksPerPass; ++block)
+        {
+            // processBlock consumes nothing from the MIDI buffer, so every pass replays the same events.
+            auto& midi = midiBlocks[static_cast<std::size_t> (block)];
+            const auto start = Clock::now();
+            processor.processBlock (buffer, midi);
+            const auto end = Clock::now();
+
+            peakVoices = std::max (peakVoices, processor.getLatestTelemetry().activeVoices);
+            if (timed && block >= untimedBlocks)
+            {
+                blockTimesNs.push_back (static_cast<double> (std::chrono::duration_cast<std::chrono::nanoseconds> (end - start).count()));
+                timedSeconds += blockSize / sampleRate;
+            }
+        }
+
+        processor.releaseResources();
+    }
+
+    auto totalNs = 0.0;
+    for (const auto time : blockTimesNs)
+        totalNs += time;
+
+    auto result = secretsynth::tools::summarise (patternName, name, "sample", blockSize, std::move (blockTimesNs));
+
+    const auto blockBudgetNs = blockSize * 1.0e9 / sampleRate;
+    const auto cpuFraction = totalNs / (timedSeconds * 1.0e9);
+    result.metrics = {
+        { "sampleRate", sampleRate },
+        { "blockSize", static_cast<double> (blockSize) },
+        { "renderedSeconds", timedSeconds },
+        { "realTimeFactor", cpuFraction > 0.0 ? 1.0 / cpuFraction : 0.0 },
+        { "cpuPercentPerInstance", 100.0 * cpuFraction },
+        { "worstBlockNs", result.maxNs },
+        { "worstBlockBudgetPercent", 100.0 * result.maxNs / blockBudgetNs },
+        { "p99BlockBudgetPercent", 100.0 * result.p99Ns / blockBudgetNs },
+        { "peakActiveVoices", static_cast<double> (peakVoices) },
+    };
+
+    std::cerr << patternName << ' ' << name << ": " << 100.0 * cpuFraction << "% CPU, worst block " << 100.0 * result.maxNs / blockBudgetNs
+              << "% of budget\n";
+    return result;
+}
+} // namespace
+
+int main (int argc, char** argv)
+{
+    const juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    // One timed pass per case by default; each pass renders secondsPerPass of audio.
+    BenchmarkSettings settings;
+    settings.warmupRepetitions = 0;
+    settings.repetitions = 1;
+    auto arguments = secretsynth::tools::parseBenchmarkArguments (argc, argv, settings);
+
+    auto secondsPerPass = 2.0;
+    std::erase_if (arguments, [&secondsPerPass] (const std::string& argument)
+    {
+        if (! argument.starts_with ("--seconds="))
+            return false;
+
+        secondsPerPass = std::max (0.1, std::stod (argument.substr (10)));
+        return true;
+    });
+
+    std::vector<BenchmarkResult> results;
+    for (const auto& [patternName, pattern] : patterns)
+    {
+        for (const auto sampleRate : sampleRates)
+        {
+            for (const auto blockSize : blockSizes)
+            {
+                const auto name = "sr=" + std::to_string (static_cast<int> (sampleRate)) + "/block=" + std::to_string (blockSize);
+                if (! secretsynth::tools::matchesFilter (settings, patternName, name))
+                    continue;
+
+                results.push_back (runCase (patternName, name, pattern, sampleRate, blockSize, secondsPerPass, settings));
+            }
+        }
+    }
+
+    const std::vector<std::pair<std::string, double>> context {
+        { "secondsPerPass", secondsPerPass },
+        { "untimedSecondsPerPass", untimedSecondsPerPass },
+        { "hardwareThreads", static_cast<double> (std::thread::hardware_concurrency()) },
+    };
+
+    if (arguments.empty())
+    {
+        secretsynth::tools::writeJson (std::cout, settings, context, results);
+        return 0;
+    }
+
+    std::ofstream output (arguments.front());
+    if (! output)
+    {
+        std::cerr << "Cannot write " << arguments.front() << '\n';
+        return 1;
+    }
+
+    secretsynth::tools::writeJson (output, settings, context, results);
+    return 0;
+}
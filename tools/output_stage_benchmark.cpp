@@ -0,0 +1,91 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "../src/dsp/mix/OutputStage.h"
+
+int main()
+{
+    using Clock = std::chrono::high_resolution_clock;
+    using secretsynth::dsp::mix::OutputStage;
+
+    constexpr int blockSize = 256;
+    constexpr int warmupBlocks = 2000;
+    constexpr int benchmarkBlocks = 40000;
+    constexpr int accuracySteps = 200000;
+    constexpr float accuracyRange = 8.0f;
+
+    // A hot signal so every block takes the saturating path.
+    std::vector<float> input (blockSize, 0.0f);
+    for (int i = 0; i < blockSize; ++i)
+        input[static_cast<std::size_t> (i)] = 1.5f * std::sin (static_cast<float> (i) * 0.05f);
+
+    std::vector<float> output (blockSize, 0.0f);
+
+    std::cout << "Output stage saturator benchmark\n";
+    std::cout << "block=" << blockSize << ", blocks=" << benchmarkBlocks << ", error range=+/-" << accuracyRange << "\n\n";
+
+    for (const auto& [name, saturator] : { std::pair { "tanh", OutputStage::Saturator::tanh },
+                                           std::pair { "pade", OutputStage::Saturator::pade },
+                                           std::pair { "cubic", OutputStage::Saturator::cubic } })
+    {
+        OutputStage stage;
+        stage.setSaturator (saturator);
+
+        auto maxError = 0.0;
+        for (int step = 0; step <= accuracySteps; ++step)
+        {
+            const auto x = -accuracyRange + 2.0f * accuracyRange * static_cast<float> (step) / accuracySteps;
+            float y = 0.0f;
+            stage.process (&x, &y, 1, 1.0f);
+            maxError = std::max (maxError, std::abs (static_cast<double> (y) - std::tanh (static_cast<double> (x))));
+        }
+
+        volatile float sink = 0.0f;
+        for (int block = 0; block < warmupBlocks; ++block)
+        {
+            stage.process (input.data(), output.data(), blockSize, 1.0f);
+            sink = sink + output[0];
+        }
+
+        const auto start = Clock::now();
+        for (int block = 0; block < benchmarkBlocks; ++block)
+        {
+            stage.process (input.data(), output.data(), blockSize, 1.0f);
+            sink = sink + output[0];
+        }
+        const auto end = Clock::now();
+
+        const auto elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds> (end - start).count();
+        const auto nsPerSample = static_cast<double> (elapsedNs) / (static_cast<double> (benchmarkBlocks) * blockSize);
+
+        std::cout << std::left << std::setw (8) << name
+                  << " max|err vs tanh|=" << std::setw (12) << std::scientific << std::setprecision (2) << maxError
+                  << " | ns/sample=" << std::fixed << std::setprecision (3) << nsPerSample << "\n";
+    }
+
+    // Quiet blocks bypass the saturator entirely.
+    std::vector<float> quiet (blockSize, 0.0f);
+    for (int i = 0; i < blockSize; ++i)
+        quiet[static_cast<std::size_t> (i)] = 0.01f * std::sin (static_cast<float> (i) * 0.05f);
+
+    OutputStage stage;
+    volatile float sink = 0.0f;
+    const auto start = Clock::now();
+    for (int block = 0; block < benchmarkBlocks; ++block)
+    {
+        stage.process (quiet.data(), output.data(), blockSize, 1.0f);
+        sink = sink + output[0];
+    }
+    const auto end = Clock::now();
+
+    const auto elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds> (end - start).count();
+    std::cout << std::left << std::setw (8) << "quiet" << " linear fast path (peak < " << OutputStage::linearThreshold << ")"
+              << " | ns/sample=" << std::fixed << std::setprecision (3)
+              << static_cast<double> (elapsedNs) / (static_cast<double> (benchmarkBlocks) * blockSize) << "\n";
+
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include <array>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "../src/dsp/trace/Trace.h"
+#include "../src/dsp/voice/VoiceManager.h"
+#include "../src/plugin/parameters/StateSerialization.h"
+
+// Plays a short chord sequence through the voice engine with tracing compiled in and writes the
+// recorded events as Chrome trace JSON to argv[1] (default secretsynth_trace.json).
+int main (int argc, char** argv)
+{
+    using secretsynth::dsp::mod::Destination;
+    using secretsynth::dsp::mod::ModulationMatrix;
+    using secretsynth::dsp::mod::Source;
+    using secretsynth::dsp::voice::Voice;
+    using secretsynth::dsp::voice::VoiceManager;
+    namespace parameters = secretsynth::plugin::parameters;
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 256;
+    constexpr int blocks = 400;
+    constexpr int blocksPerChord = 25;
+    constexpr std::array chord { 0, 4, 7, 11 };
+
+    const auto* path = argc > 1 ? argv[1] : "secretsynth_trace.json";
+
+    ModulationMatrix matrix;
+    matrix.addRoute ({ Source::lfo1, Destination::pdAmount, 0.25f, true });
+    matrix.addRoute ({ Source::modEnv, Destination::filterCutoff, 0.8f, false });
+    matrix.addRoute ({ Source::ampEnv, Destination::amp, 1.0f, false });
+
+    Voice::RenderParameters renderParameters;
+    std::vector<float> lfo (blockSize, 0.5f);
+    std::vector<float> left (blockSize, 0.0f);
+    std::vector<float> right (blockSize, 0.0f);
+    const Voice::RenderContext context { &renderParameters, &matrix, lfo.data(), lfo.data() };
+
+    VoiceManager manager ({ .mode = VoiceManager::Mode::poly, .maxVoices = 16 });
+    manager.prepare (sampleRate, blockSize);
+
+    const auto state = parameters::deserializeState (parameters::serializeState (parameters::makeDefaultState()));
+    static_cast<void> (state);
+
+    auto root = 48;
+    for (int block = 0; block < blocks; ++block)
+    {
+        SECRETSYNTH_TRACE_SCOPE ("renderBlock");
+
+        if (block % blocksPerChord == 0)
+        {
+            for (const auto interval : chord)
+                manager.noteOff (root + interval);
+
+            root = 48 + (block / blocksPerChord) % 12;
+            for (const auto interval : chord)
+                manager.noteOn (root + interval, 0.8f);
+        }
+
+        std::fill (left.begin(), left.end(), 0.0f);
+        std::fill (right.begin(), right.end(), 0.0f);
+        manager.render (left.data(), right.data(), blockSize, context);
+    }
+
+    std::ofstream output (path);
+    if (! output)
+    {
+        std::cerr << "Cannot write " << path << '\n';
+        return 1;
+    }
+
+    secretsynth::dsp::trace::writeChromeTrace (output);
+    std::cout << "Wrote " << path << '\n';
+    return 0;
+}
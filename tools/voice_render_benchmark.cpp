@@ -0,0 +1,88 @@
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "../src/dsp/voice/RenderThreadPool.h"
+#include "../src/dsp/voice/VoiceManager.h"
+
+int main()
+{
+    using Clock = std::chrono::high_resolution_clock;
+    using secretsynth::dsp::mod::Destination;
+    using secretsynth::dsp::mod::ModulationMatrix;
+    using secretsynth::dsp::mod::Source;
+    using secretsynth::dsp::voice::RenderThreadPool;
+    using secretsynth::dsp::voice::Voice;
+    using secretsynth::dsp::voice::VoiceManager;
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 256;
+    constexpr int notes = 16;
+    constexpr int unison = 4;
+    constexpr int warmupBlocks = 50;
+    constexpr int benchmarkBlocks = 2000;
+
+    const auto maxWorkers = std::max (0, static_cast<int> (std::thread::hardware_concurrency()) - 1);
+
+    ModulationMatrix matrix;
+    matrix.addRoute ({ Source::lfo1, Destination::pdAmount, 0.25f, true });
+    matrix.addRoute ({ Source::modEnv, Destination::filterCutoff, 0.8f, false });
+    matrix.addRoute ({ Source::ampEnv, Destination::amp, 1.0f, false });
+
+    Voice::RenderParameters parameters;
+    std::vector<float> lfo (blockSize, 0.5f);
+    std::vector<float> left (blockSize, 0.0f);
+    std::vector<float> right (blockSize, 0.0f);
+    const Voice::RenderContext context { &parameters, &matrix, lfo.data(), lfo.data() };
+
+    std::cout << "Voice render scaling benchmark\n";
+    std::cout << "notes=" << notes << " x unison=" << unison << ", block=" << blockSize
+              << ", blocks=" << benchmarkBlocks << "\n\n";
+
+    double singleThreadNs = 0.0;
+
+    for (int workers = 0; workers <= maxWorkers; ++workers)
+    {
+        RenderThreadPool pool (workers);
+        VoiceManager manager ({
+            .mode = VoiceManager::Mode::unison,
+            .maxVoices = notes * unison,
+            .unisonVoices = unison,
+        });
+
+        manager.prepare (sampleRate, blockSize, notes * unison);
+        manager.setRenderThreadPool (&pool, 1.0e6); // time the full render, never cut it short
+
+        for (int note = 0; note < notes; ++note)
+            manager.noteOn (48 + note, 0.8f);
+
+        for (int block = 0; block < warmupBlocks; ++block)
+            manager.render (left.data(), right.data(), blockSize, context);
+
+        const auto start = Clock::now();
+        for (int block = 0; block < benchmarkBlocks; ++block)
+        {
+            std::fill (left.begin(), left.end(), 0.0f);
+            std::fill (right.begin(), right.end(), 0.0f);
+            manager.render (left.data(), right.data(), blockSize, context);
+        }
+        const auto end = Clock::now();
+
+        const auto nsPerBlock = static_cast<double> (std::chrono::duration_cast<std::chrono::nanoseconds> (end - start).count())
+                              / benchmarkBlocks;
+        if (workers == 0)
+            singleThreadNs = nsPerBlock;
+
+        const auto blockBudgetNs = blockSize * 1'000'000'000.0 / sampleRate;
+
+        std::cout << "threads=" << std::left << std::setw (4) << workers + 1
+                  << " ns/block=" << std::setw (12) << std::fixed << std::setprecision (0) << nsPerBlock
+                  << " | speedup=" << std::setw (6) << std::setprecision (2) << singleThreadNs / nsPerBlock
+                  << " | est% of realtime @48k=" << std::setprecision (1) << nsPerBlock * 100.0 / blockBudgetNs << "\n";
+    }
+
+    return 0;
+}